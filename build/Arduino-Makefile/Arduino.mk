@@ -1417,6 +1417,8 @@ help:
   burn_bootloader   - burn bootloader and fuses\n\
   set_fuses         - set fuses without burning bootloader\n\
   avanti            - short cut for upload and monitor\n\
+  sim               - run on simavr virtual board and capture uart\n\
+                      output (see Cosa.mk).\n\
   help              - show this help\n\
 More details in:\n\
 $(ARDMK_DIR)/Arduino.mk\n\
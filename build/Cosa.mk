@@ -37,3 +37,22 @@ BOARDS_TXT = $(COSA_DIR)/build/boards.txt
 MONITOR_CMD = $(COSA_DIR)/build/miniterm.py -q --lf
 
 include $(ARDMK_DIR)/Arduino.mk
+
+# Simulation with simavr; run the sketch on a virtual board and
+# capture the UART output. The simulation is stopped when the sketch
+# terminates (fatal/assert) or after SIMAVR_TIMEOUT seconds. With
+# SIMAVR_CYCLES=1 the sketch is built with COSA_MEASURE_CYCLES and
+# MEASURE prints clock cycles (timer1) instead of micro-seconds. Use
+# clean before changing SIMAVR_CYCLES.
+SIMAVR ?= run_avr
+SIMAVR_TIMEOUT ?= 60
+SIMAVR_OUTPUT = $(OBJDIR)/$(TARGET).sim
+ifdef SIMAVR_CYCLES
+CPPFLAGS += -DCOSA_MEASURE_CYCLES
+endif
+
+sim: $(TARGET_ELF)
+	@SIMAVR=$(SIMAVR) $(COSA_DIR)/build/simulate $(MCU) $(F_CPU) \
+		$(TARGET_ELF) $(SIMAVR_TIMEOUT) | tee $(SIMAVR_OUTPUT)
+
+.PHONY: sim
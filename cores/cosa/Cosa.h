@@ -37,9 +37,17 @@
  */
 
 /**
- * Event queue size. Default is 16 entries (8 ATTINY).
+ * Event priority levels. Default is 4 levels (1 ATTINY).
  * In file: Cosa/Event.hh
- * #define COSA_EVENT_QUEUE_MAX 16
+ * #define COSA_EVENT_PRIORITY_MAX 4
+ */
+
+/**
+ * Event queue size per priority level. Default is 8 entries (16 with
+ * a single priority level). Use Event::queue.high_water_mark() and
+ * dropped() to size.
+ * In file: Cosa/Event.hh
+ * #define COSA_EVENT_QUEUE_MAX 8
  */
 
 /**
@@ -62,4 +70,21 @@
  * In file: Cosa/IOStream.hh
  * #define COSA_IOSTREAM_STDLIB_DTOA
  */
+
+/**
+ * FAT16 block cache size. Default is 4 blocks (1 for 2 Kbyte SRAM
+ * devices). Use FAT16::cache_stat() to size.
+ * In file: FAT16/FAT16.hh
+ * #define COSA_FAT16_CACHE_MAX 4
+ */
+
+/**
+ * Runtime profiler; interrupt disabled cycles per synchronized
+ * block, interrupt entry latency and stack high water mark. Uses
+ * Timer1. Default is disabled. Number of recorded synchronized block
+ * call sites. Default is 16.
+ * In file: Cosa/Profiler.hh
+ * #define COSA_PROFILE
+ * #define COSA_PROFILE_SITE_MAX 16
+ */
 #endif
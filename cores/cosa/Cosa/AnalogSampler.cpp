@@ -0,0 +1,135 @@
+/**
+ * @file Cosa/AnalogSampler.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Cosa/AnalogSampler.hh"
+
+#if !defined(BOARD_ATTINY)
+
+#include "Cosa/Power.hh"
+
+bool
+AnalogSampler::begin(uint16_t us)
+{
+  // Check that the ADC is not in use
+  loop_until_bit_is_clear(ADCSRA, ADSC);
+  synchronized {
+    if (UNLIKELY(sampling_pin != NULL)) return (false);
+    sampling_pin = this;
+  }
+
+  // Initiate scan state and double buffer
+  m_channel = 0;
+  m_conv = (1 << (2 * m_decimate));
+  m_sum = 0;
+  m_pos = 0;
+  m_half = 0;
+  m_held = 0;
+  m_dropped = 0;
+
+  // Timer1 in CTC mode (top OCR1A); select prescale for period
+  uint32_t cycles = (uint32_t) us * I_CPU;
+  uint8_t cs = _BV(CS10);
+  if (cycles > 0x10000L) {
+    cycles /= 8;
+    cs = _BV(CS11);
+    if (cycles > 0x10000L) {
+      cycles /= 8;
+      cs = _BV(CS11) | _BV(CS10);
+    }
+  }
+  if (cycles == 0) cycles = 1;
+  Power::timer1_enable();
+  synchronized {
+    TCCR1B = 0;
+    TCCR1A = 0;
+    TCNT1 = 0;
+    OCR1A = cycles - 1;
+    OCR1B = 0;
+    TIFR1 = _BV(OCF1B);
+    TCCR1B = _BV(WGM12) | cs;
+  }
+
+  // ADC auto trigger on Timer1 compare match B
+  Power::adc_enable();
+  select(0);
+  ADCSRB = (ADCSRB & ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0)))
+    | _BV(ADTS2) | _BV(ADTS0);
+  bit_mask_set(ADCSRA, _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADIF));
+  return (true);
+}
+
+void
+AnalogSampler::end()
+{
+  synchronized {
+    if (UNLIKELY(sampling_pin != this)) return;
+    bit_mask_clear(ADCSRA, _BV(ADATE) | _BV(ADIE));
+    TCCR1B = 0;
+    sampling_pin = NULL;
+  }
+  Power::timer1_disable();
+}
+
+void
+AnalogSampler::on_interrupt(uint16_t value)
+{
+  // Clear trigger flag and continue sampling
+  TIFR1 = _BV(OCF1B);
+  bit_set(ADCSRA, ADIE);
+
+  // Accumulate and decimate
+  m_sum += value;
+  if (--m_conv != 0) return;
+  m_conv = (1 << (2 * m_decimate));
+  uint16_t sample = m_sum >> m_decimate;
+  m_sum = 0;
+
+  // Select next channel
+  uint8_t channel = m_channel;
+  if (++m_channel == m_count) m_channel = 0;
+  select(m_channel);
+
+  // Start new blocks with the first channel and when not held
+  if (m_pos == 0 && ((channel != 0) || (m_held & _BV(m_half)))) {
+    m_dropped += 1;
+    return;
+  }
+
+  // Store sample and push event when block is completed. The block
+  // is dropped and the half reused if the event queue is full
+  m_buffer[m_half * m_size + m_pos] = sample;
+  if (++m_pos != m_size) return;
+  m_pos = 0;
+  if (UNLIKELY(!Event::push(Event::SAMPLE_COMPLETED_TYPE, this, m_half))) {
+    m_dropped += m_size;
+    return;
+  }
+  m_held |= _BV(m_half);
+  m_half ^= 1;
+}
+
+void
+AnalogSampler::on_event(uint8_t type, uint16_t value)
+{
+  if (UNLIKELY(type != Event::SAMPLE_COMPLETED_TYPE)) return;
+  on_block(m_buffer + value * m_size, m_size);
+  synchronized m_held &= ~_BV(value);
+}
+#endif
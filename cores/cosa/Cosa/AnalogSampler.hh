@@ -0,0 +1,183 @@
+/**
+ * @file Cosa/AnalogSampler.hh
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#ifndef COSA_ANALOG_SAMPLER_HH
+#define COSA_ANALOG_SAMPLER_HH
+
+#include "Cosa/AnalogPin.hh"
+
+#if !defined(BOARD_ATTINY)
+
+/**
+ * Free running multi-channel analog sampler. Conversions are
+ * triggered by Timer1 (compare match B) with a given period. The
+ * interrupt handler scans the channel list and writes the samples
+ * into one half of a double buffer. One event is pushed per
+ * completed block (half) and the block is passed to on_block().
+ * The interrupt handler continues with the other half while the
+ * block is processed. If both halves are held the samples are
+ * dropped until a block is released; whole blocks are dropped so
+ * that the channel order is kept.
+ *
+ * Optional oversampling and decimation; 4**N conversions per channel
+ * are accumulated and shifted right N bits for N additional bits of
+ * resolution (N = 1..3). The channels are sampled in sequence; the
+ * effective sample rate per channel is the conversion rate divided
+ * by the number of channels and the oversampling factor.
+ *
+ * The block size must be a multiple of the number of channels. The
+ * buffer must hold two blocks. Timer1 may not be used by other
+ * modules while sampling (e.g. Servo, Tone, VWI and Profiler).
+ *
+ * @section Usage
+ * @code
+ * const Board::AnalogPin pins[] __PROGMEM = { Board::A0, Board::A1 };
+ * uint16_t buffer[2 * 32];
+ * class Sampler : public AnalogSampler {
+ * public:
+ *   Sampler() : AnalogSampler(pins, membersof(pins), buffer, 32, 1) {}
+ *   virtual void on_block(const uint16_t* block, uint16_t size) { ... }
+ * };
+ * Sampler sampler;
+ * ...
+ * sampler.begin(250);
+ * @endcode
+ */
+class AnalogSampler : public AnalogPin {
+public:
+  /** Max decimation; additional bits of resolution. */
+  static const uint8_t DECIMATE_MAX = 3;
+
+  /**
+   * Construct analog sampler with given channel vector (in program
+   * memory), number of channels, sample buffer (two blocks), block
+   * size, decimation (additional bits) and reference voltage.
+   * @param[in] pins vector with analog pins (program memory).
+   * @param[in] count number of pins in vector.
+   * @param[in] buffer for two blocks of samples.
+   * @param[in] size number of samples per block.
+   * @param[in] decimate additional bits (Default 0, no oversampling).
+   * @param[in] ref reference voltage.
+   */
+  AnalogSampler(const Board::AnalogPin* pins, uint8_t count,
+		uint16_t* buffer, uint16_t size,
+		uint8_t decimate = 0,
+		Board::Reference ref = Board::AVCC_REFERENCE) :
+    AnalogPin((Board::AnalogPin) 255, ref),
+    m_pins(pins),
+    m_count(count),
+    m_buffer(buffer),
+    m_size(size),
+    m_decimate(decimate > DECIMATE_MAX ? DECIMATE_MAX : decimate),
+    m_channel(0),
+    m_conv(0),
+    m_sum(0),
+    m_pos(0),
+    m_half(0),
+    m_held(0),
+    m_dropped(0)
+  {}
+
+  /**
+   * Start sampling with given conversion period in micro-seconds.
+   * The period should be larger than the conversion time (13 ADC
+   * clock cycles, see AnalogPin::prescale()). Returns false if the
+   * ADC is in use otherwise true.
+   * @param[in] us conversion period.
+   * @return bool.
+   */
+  bool begin(uint16_t us);
+
+  /**
+   * Stop sampling. Blocks in the event queue are still delivered.
+   */
+  void end();
+
+  /**
+   * Return number of dropped samples.
+   * @return samples.
+   */
+  uint16_t dropped() const
+  {
+    uint16_t res;
+    synchronized res = m_dropped;
+    return (res);
+  }
+
+  /**
+   * @override{AnalogSampler}
+   * Called with completed block of samples. The samples are in
+   * channel order. The block is released on return.
+   * @param[in] block of samples.
+   * @param[in] size number of samples in block.
+   */
+  virtual void on_block(const uint16_t* block, uint16_t size)
+  {
+    UNUSED(block);
+    UNUSED(size);
+  }
+
+  /**
+   * @override{Interrupt::Handler}
+   * Interrupt service on conversion completion. Accumulate and
+   * decimate, select next channel and store sample in block.
+   * @param[in] value sample value.
+   */
+  virtual void on_interrupt(uint16_t value);
+
+protected:
+  const Board::AnalogPin* m_pins; //!< Channel vector (program memory).
+  const uint8_t m_count;	  //!< Number of channels.
+  uint16_t* m_buffer;		  //!< Double buffer.
+  const uint16_t m_size;	  //!< Block size.
+  const uint8_t m_decimate;	  //!< Additional bits.
+  uint8_t m_channel;		  //!< Current channel (index).
+  uint8_t m_conv;		  //!< Conversions left for channel.
+  uint16_t m_sum;		  //!< Oversampling accumulator.
+  uint16_t m_pos;		  //!< Position in current block.
+  uint8_t m_half;		  //!< Current block (0..1).
+  volatile uint8_t m_held;	  //!< Blocks held by handler (bitmap).
+  uint16_t m_dropped;		  //!< Dropped samples.
+
+  /**
+   * Select given channel for the next conversion.
+   * @param[in] ix channel index.
+   */
+  void select(uint8_t ix)
+    __attribute__((always_inline))
+  {
+    uint8_t pin = pgm_read_byte(&m_pins[ix]);
+    ADMUX = (m_reference | (pin & 0x1f));
+#if defined(MUX5)
+    bit_write(pin & 0x20, ADCSRB, MUX5);
+#endif
+  }
+
+  /**
+   * @override{Event::Handler}
+   * Deliver completed block to on_block() and release.
+   * @param[in] type the type of event.
+   * @param[in] value the event value (block).
+   */
+  virtual void on_event(uint8_t type, uint16_t value);
+};
+
+#endif
+#endif
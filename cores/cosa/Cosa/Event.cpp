@@ -21,10 +21,10 @@
 #include "Cosa/Event.hh"
 #include "Cosa/Watchdog.hh"
 
-Queue<Event, Event::QUEUE_MAX> Event::queue;
+Event::PriorityQueue Event::queue;
 
-bool
-Event::service(uint32_t ms)
+uint8_t
+Event::service(uint32_t ms, uint8_t max)
 {
   uint32_t start = Watchdog::millis();
   Event event;
@@ -32,9 +32,61 @@ Event::service(uint32_t ms)
     if ((ms == 0L) || (Watchdog::since(start) < ms))
       yield();
     else
+      return (0);
+  }
+
+  // Dispatch events in priority order; higher priority events pushed
+  // during dispatch are serviced first
+  uint8_t count = 0;
+  do {
+    event.dispatch();
+    count += 1;
+  } while ((count < max) && queue.dequeue(&event));
+  return (count);
+}
+
+uint8_t
+Event::PriorityQueue::available() const
+{
+  uint8_t res = 0;
+  for (uint8_t level = 0; level < PRIORITY_MAX; level++)
+    res += m_queue[level].available();
+  return (res);
+}
+
+bool
+Event::PriorityQueue::enqueue(Event* event, uint8_t level)
+{
+  if (UNLIKELY(level >= PRIORITY_MAX)) level = PRIORITY_MAX - 1;
+  synchronized {
+    Queue<Event, QUEUE_MAX>* queue = &m_queue[level];
+    if (UNLIKELY(!queue->enqueue(event))) {
+      m_dropped[level] += 1;
       return (false);
+    }
+    uint8_t count = queue->available();
+    if (count > m_high_water_mark[level])
+      m_high_water_mark[level] = count;
   }
-  event.dispatch();
   return (true);
 }
 
+bool
+Event::PriorityQueue::dequeue(Event* event)
+{
+  for (uint8_t level = 0; level < PRIORITY_MAX; level++)
+    if (m_queue[level].dequeue(event)) return (true);
+  return (false);
+}
+
+void
+Event::PriorityQueue::reset()
+{
+  synchronized {
+    for (uint8_t level = 0; level < PRIORITY_MAX; level++) {
+      m_dropped[level] = 0;
+      m_high_water_mark[level] = 0;
+    }
+  }
+}
+
@@ -24,9 +24,18 @@
 #include "Cosa/Types.h"
 #include "Cosa/Queue.hh"
 
-// Default event queue size
-#ifndef COSA_EVENT_QUEUE_MAX
+// Default number of event priority levels
+#ifndef COSA_EVENT_PRIORITY_MAX
 # if defined(BOARD_ATTINY)
+#   define COSA_EVENT_PRIORITY_MAX 1
+# else
+#   define COSA_EVENT_PRIORITY_MAX 4
+# endif
+#endif
+
+// Default event queue size (per priority level)
+#ifndef COSA_EVENT_QUEUE_MAX
+# if defined(BOARD_ATTINY) || (COSA_EVENT_PRIORITY_MAX > 1)
 #   define COSA_EVENT_QUEUE_MAX 8
 # else
 #   define COSA_EVENT_QUEUE_MAX 16
@@ -39,11 +48,31 @@
 class Event {
 public:
   /**
-   * Size of event queue. Adjust depending on application. Must be
-   * Power(2). Class Queue will statically check this.
+   * Size of event queue per priority level. Adjust depending on
+   * application. Must be Power(2). Class Queue will statically check
+   * this.
    */
   static const uint8_t QUEUE_MAX = COSA_EVENT_QUEUE_MAX;
 
+  /**
+   * Event priority levels. Each level has a queue of size QUEUE_MAX
+   * so that a burst of events on one level will not cause events on
+   * other levels to be dropped. Events are dispatched in priority
+   * order; lowest level first. Levels from PRIORITY_MAX are mapped
+   * to the lowest priority level available.
+   */
+  enum Priority {
+    ISR_PRIORITY = 0,		//!< Pin change and sample events.
+    IO_PRIORITY = 1,		//!< Device driver and protocol events.
+    TIMER_PRIORITY = 2,		//!< Watchdog and timeout events.
+    USER_PRIORITY = 3		//!< State machine, thread and user events.
+  } __attribute__((packed));
+
+  /**
+   * Number of event priority levels and queues.
+   */
+  static const uint8_t PRIORITY_MAX = COSA_EVENT_PRIORITY_MAX;
+
   /**
    * Event types are added here. Typical mapping from interrupts to
    * events. Note that the event is not a global numbering
@@ -169,8 +198,27 @@ public:
     if (m_target != NULL) m_target->on_event(m_type, m_value);
   }
 
+  /**
+   * Return default priority level for given event type.
+   * @param[in] type event identity.
+   * @return priority level.
+   */
+  static uint8_t priority(uint8_t type)
+    __attribute__((always_inline))
+  {
+    uint8_t level;
+    if (type >= USER_TYPE) level = USER_PRIORITY;
+    else if (type >= CONNECT_TYPE) level = IO_PRIORITY;
+    else if (type >= BEGIN_TYPE) level = USER_PRIORITY;
+    else if (type >= WATCHDOG_TYPE) level = TIMER_PRIORITY;
+    else if (type >= FALLING_TYPE) level = ISR_PRIORITY;
+    else level = USER_PRIORITY;
+    return (level < PRIORITY_MAX ? level : PRIORITY_MAX - 1);
+  }
+
   /**
    * Push an event with given type, source and value into the event queue.
+   * The priority level is given by the event type.
    * Return true(1) if successful otherwise false(0).
    * @param[in] type event identity.
    * @param[in] target event target.
@@ -178,11 +226,21 @@ public:
    * @return bool.
    */
   static bool push(uint8_t type, Handler* target, uint16_t value = 0)
-    __attribute__((always_inline))
-  {
-    Event event(type, target, value);
-    return (queue.enqueue(&event));
-  }
+    __attribute__((always_inline));
+
+  /**
+   * Push an event with given type, source and value into the event
+   * queue with the given priority level. Return true(1) if successful
+   * otherwise false(0).
+   * @param[in] type event identity.
+   * @param[in] target event target.
+   * @param[in] value event value.
+   * @param[in] level priority level.
+   * @return bool.
+   */
+  static bool push(uint8_t type, Handler* target, uint16_t value,
+		   Priority level)
+    __attribute__((always_inline));
 
   /**
    * Push an event with given type, source and value into the event queue.
@@ -199,17 +257,21 @@ public:
   }
 
   /**
-   * Event queue of size QUEUE_MAX.
+   * Event priority queues; PRIORITY_MAX queues of size QUEUE_MAX.
    */
-  static Queue<Event, QUEUE_MAX> queue;
+  class PriorityQueue;
+  static PriorityQueue queue;
 
   /**
    * Service events and wait at most given number of milliseconds. The
    * value zero(0) indicates that call should block until an event.
+   * When an event is available at most the given number of events
+   * are dispatched in priority order without waiting.
    * @param[in] ms maximum wait time (Default blocking).
-   * @return true(1) if an event was dispatched otherwise false(0).
+   * @param[in] max number of events to dispatch (Default 1).
+   * @return number of events dispatched.
    */
-  static bool service(uint32_t ms = 0L);
+  static uint8_t service(uint32_t ms = 0L, uint8_t max = 1);
 
 private:
   uint8_t m_type;		//!< Event type.
@@ -217,5 +279,124 @@ private:
   uint16_t m_value;		//!< Event parameter and/or value.
 };
 
+/**
+ * Event priority queues. Events are enqueued on the priority level
+ * given by the event type (or explicitly) and dequeued in priority
+ * order. Keeps statistics of dropped events and high-water mark per
+ * level to allow sizing of the queues (COSA_EVENT_QUEUE_MAX).
+ */
+class Event::PriorityQueue {
+public:
+  /**
+   * Construct event priority queues.
+   */
+  PriorityQueue()
+  {
+    reset();
+  }
+
+  /**
+   * Return number of events in all queues.
+   * @return available events.
+   */
+  uint8_t available() const;
+
+  /**
+   * Return number of events in queue with given priority level.
+   * @param[in] level priority level.
+   * @return available events.
+   */
+  uint8_t available(uint8_t level) const
+  {
+    return (m_queue[level].available());
+  }
+
+  /**
+   * Enqueue given event on the priority level given by the event
+   * type. Return true(1) if successful otherwise false(0).
+   * @param[in] event pointer to event.
+   * @return bool.
+   * @note atomic
+   */
+  bool enqueue(Event* event)
+    __attribute__((always_inline))
+  {
+    return (enqueue(event, Event::priority(event->type())));
+  }
+
+  /**
+   * Enqueue given event on the given priority level. Return true(1)
+   * if successful otherwise false(0), and the event was dropped.
+   * @param[in] event pointer to event.
+   * @param[in] level priority level.
+   * @return bool.
+   * @note atomic
+   */
+  bool enqueue(Event* event, uint8_t level);
+
+  /**
+   * Dequeue event with highest priority to given buffer. Returns
+   * true(1) if an event was available otherwise false(0).
+   * @param[in,out] event pointer to event buffer.
+   * @return bool.
+   * @note atomic
+   */
+  bool dequeue(Event* event);
+
+  /**
+   * Await event to become available. Will yield until an event is
+   * available.
+   * @param[in,out] event pointer to event buffer.
+   */
+  void await(Event* event)
+  {
+    while (!dequeue(event)) yield();
+  }
+
+  /**
+   * Return number of dropped events on given priority level.
+   * @param[in] level priority level.
+   * @return number of dropped events.
+   */
+  uint16_t dropped(uint8_t level) const
+  {
+    return (m_dropped[level]);
+  }
+
+  /**
+   * Return max number of events queued on given priority level.
+   * @param[in] level priority level.
+   * @return high-water mark.
+   */
+  uint8_t high_water_mark(uint8_t level) const
+  {
+    return (m_high_water_mark[level]);
+  }
+
+  /**
+   * Reset statistics.
+   */
+  void reset();
+
+private:
+  Queue<Event, QUEUE_MAX> m_queue[PRIORITY_MAX]; //!< Priority queues.
+  uint16_t m_dropped[PRIORITY_MAX];	//!< Dropped events per level.
+  uint8_t m_high_water_mark[PRIORITY_MAX]; //!< Max queued per level.
+};
+
+inline bool
+Event::push(uint8_t type, Handler* target, uint16_t value)
+{
+  Event event(type, target, value);
+  return (queue.enqueue(&event));
+}
+
+inline bool
+Event::push(uint8_t type, Handler* target, uint16_t value, Priority level)
+{
+  Event event(type, target, value);
+  return (queue.enqueue(&event, level));
+}
+
 #endif
 
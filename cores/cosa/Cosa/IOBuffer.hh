@@ -30,6 +30,13 @@
  * string buffer device, or to connect different IOStreams. See
  * UART.hh for an example. Buffer size should be power of 2 and
  * max 32Kbyte.
+ *
+ * Block write and read are performed with at most two memory copies
+ * across the buffer wrap. Zero-copy access is possible with
+ * reserve()/commit() for a writer and peek()/consume() for a
+ * reader. These return a contiguous span of the buffer. The buffer
+ * may be shared by a single writer and a single reader, e.g. an
+ * interrupt handler and the main loop.
  * @param[in] SIZE number of bytes in buffer.
  */
 template <uint16_t SIZE>
@@ -117,6 +124,99 @@ public:
    */
   virtual int getchar();
 
+  /** Overloaded virtual member function write. */
+  using IOStream::Device::write;
+
+  /** Overloaded virtual member function read. */
+  using IOStream::Device::read;
+
+  /**
+   * @override{IOStream::Device}
+   * Write data from buffer with given size to buffer. Returns number
+   * of bytes written; less than size if the buffer is full.
+   * @param[in] buf buffer to write.
+   * @param[in] size number of bytes to write.
+   * @return number of bytes written.
+   */
+  virtual int write(const void* buf, size_t size);
+
+  /**
+   * @override{IOStream::Device}
+   * Write data from buffer in program memory with given size to
+   * buffer. Returns number of bytes written; less than size if the
+   * buffer is full.
+   * @param[in] buf buffer in program memory to write.
+   * @param[in] size number of bytes to write.
+   * @return number of bytes written.
+   */
+  virtual int write_P(const void* buf, size_t size);
+
+  /**
+   * @override{IOStream::Device}
+   * Read data to given buffer with given size from buffer. Returns
+   * number of bytes read; less than size if the buffer is empty.
+   * @param[in] buf buffer to read into.
+   * @param[in] size number of bytes to read.
+   * @return number of bytes read.
+   */
+  virtual int read(void* buf, size_t size);
+
+  /**
+   * Reserve contiguous space for writing. Returns pointer to the
+   * space and the number of bytes available in given count. Count is
+   * zero(0) if the buffer is full. The data is added to the buffer
+   * with commit().
+   * @param[out] count number of bytes contiguous space.
+   * @return pointer to space.
+   */
+  char* reserve(uint16_t& count)
+  {
+    uint16_t next = (m_head + 1) & MASK;
+    uint16_t room = (SIZE - m_head + m_tail - 1) & MASK;
+    count = SIZE - next;
+    if (count > room) count = room;
+    return (&m_buffer[next]);
+  }
+
+  /**
+   * Commit given number of bytes written to space returned by
+   * reserve().
+   * @param[in] count number of bytes.
+   * @pre count less or equal to reserved count.
+   */
+  void commit(uint16_t count)
+    __attribute__((always_inline))
+  {
+    m_head = (m_head + count) & MASK;
+  }
+
+  /**
+   * Peek at contiguous data in buffer. Returns pointer to data and
+   * the number of bytes in given count. Count is zero(0) if the buffer
+   * is empty. The data is removed from the buffer with consume().
+   * @param[out] count number of bytes contiguous data.
+   * @return pointer to data.
+   */
+  const char* peek(uint16_t& count)
+  {
+    uint16_t next = (m_tail + 1) & MASK;
+    uint16_t available = (SIZE + m_head - m_tail) & MASK;
+    count = SIZE - next;
+    if (count > available) count = available;
+    return (&m_buffer[next]);
+  }
+
+  /**
+   * Consume given number of bytes of data returned by peek().
+   * @param[in] count number of bytes.
+   * @pre count less or equal to peeked count.
+   */
+  void consume(uint16_t count)
+    __attribute__((always_inline))
+  {
+    m_tail = (m_tail + count) & MASK;
+  }
+
   /**
    * @override{IOStream::Device}
    * Wait for the buffer to become empty.
@@ -193,6 +293,66 @@ IOBuffer<SIZE>::getchar()
   return (m_buffer[next] & 0xff);
 }
 
+template <uint16_t SIZE>
+int
+IOBuffer<SIZE>::write(const void* buf, size_t size)
+{
+  const char* bp = (const char*) buf;
+  size_t res = 0;
+  for (uint8_t i = 0; (i < 2) && (size != 0); i++) {
+    uint16_t count;
+    char* dest = reserve(count);
+    if (count == 0) break;
+    if (count > size) count = size;
+    memcpy(dest, bp, count);
+    commit(count);
+    bp += count;
+    size -= count;
+    res += count;
+  }
+  return (res);
+}
+
+template <uint16_t SIZE>
+int
+IOBuffer<SIZE>::write_P(const void* buf, size_t size)
+{
+  const char* bp = (const char*) buf;
+  size_t res = 0;
+  for (uint8_t i = 0; (i < 2) && (size != 0); i++) {
+    uint16_t count;
+    char* dest = reserve(count);
+    if (count == 0) break;
+    if (count > size) count = size;
+    memcpy_P(dest, bp, count);
+    commit(count);
+    bp += count;
+    size -= count;
+    res += count;
+  }
+  return (res);
+}
+
+template <uint16_t SIZE>
+int
+IOBuffer<SIZE>::read(void* buf, size_t size)
+{
+  char* bp = (char*) buf;
+  size_t res = 0;
+  for (uint8_t i = 0; (i < 2) && (size != 0); i++) {
+    uint16_t count;
+    const char* src = peek(count);
+    if (count == 0) break;
+    if (count > size) count = size;
+    memcpy(bp, src, count);
+    consume(count);
+    bp += count;
+    size -= count;
+    res += count;
+  }
+  return (res);
+}
+
 template <uint16_t SIZE>
 int
 IOBuffer<SIZE>::flush()
@@ -0,0 +1,185 @@
+/**
+ * @file Cosa/Profiler.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Cosa/Profiler.hh"
+
+#if defined(COSA_PROFILE)
+
+#include "Cosa/Power.hh"
+
+// Latency probe period in cycles (approx. 1 KHz @ 16 MHz) and dither
+#define PROBE_PERIOD 16384
+#define PROBE_DITHER 0xff
+
+Profiler::site_t Profiler::s_site[SITE_MAX];
+uint8_t Profiler::s_sites = 0;
+uint16_t Profiler::s_dropped = 0;
+uint16_t Profiler::s_latency[VECTOR_MAX];
+
+/**
+ * Paint the memory from the end of static data to the end of memory
+ * before the run-time is initiated. The stack pointer and zero
+ * register are not yet set up so only registers may be used.
+ */
+void __profile_paint(void) __attribute__((naked, used, section(".init1")));
+void __profile_paint(void)
+{
+  __asm__ __volatile__("    ldi r30, lo8(_end)\n"
+		       "    ldi r31, hi8(_end)\n"
+		       "    ldi r24, %0\n"
+		       "    ldi r25, hi8(__stack)\n"
+		       "    rjmp 2f\n"
+		       "1:  st Z+, r24\n"
+		       "2:  cpi r30, lo8(__stack)\n"
+		       "    cpc r31, r25\n"
+		       "    brlo 1b\n"
+		       "    breq 1b\n"
+		       :
+		       : "i" (Profiler::PAINT));
+}
+
+void
+__profile_unlock(__profile_key_t* key)
+{
+  uint16_t stop = TCNT1;
+  SREG = key->key;
+  __asm__ __volatile__("" ::: "memory");
+  Profiler::lock_time(key->file, key->line, stop - key->start);
+}
+
+void
+Profiler::begin()
+{
+  uint8_t key = lock();
+  memset(s_site, 0, sizeof(s_site));
+  memset(s_latency, 0, sizeof(s_latency));
+  s_sites = 0;
+  s_dropped = 0;
+
+  // Start Timer1 free running without prescale. Enable latency probe
+  Power::timer1_enable();
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TCNT1 = 0;
+  OCR1B = PROBE_PERIOD;
+  TIFR1 = _BV(OCF1B);
+  TIMSK1 = _BV(OCIE1B);
+  unlock(key);
+}
+
+void
+Profiler::end()
+{
+  uint8_t key = lock();
+  TIMSK1 = 0;
+  TCCR1B = 0;
+  Power::timer1_disable();
+  unlock(key);
+}
+
+void
+Profiler::lock_time(str_P file, uint16_t line, uint16_t cycles)
+{
+  // Lookup the call site. Sites are only appended so the search may
+  // be performed with interrupts enabled
+  site_t* site = s_site;
+  uint8_t sites = s_sites;
+  for (uint8_t i = 0; i < sites; i++, site++)
+    if (site->line == line && site->file == file) goto update;
+
+  // Append new call site; check that it was not added by an interrupt
+  // handler during the search
+  {
+    uint8_t key = lock();
+    for (; sites < s_sites; sites++, site++)
+      if (site->line == line && site->file == file) break;
+    if (sites == s_sites) {
+      if (UNLIKELY(sites == SITE_MAX)) {
+	s_dropped += 1;
+	unlock(key);
+	return;
+      }
+      site->file = file;
+      site->line = line;
+      s_sites = sites + 1;
+    }
+    unlock(key);
+  }
+
+  // Update call site statistics
+ update:
+  uint8_t key = lock();
+  if (site->count != UINT16_MAX) site->count += 1;
+  if (cycles > site->max) site->max = cycles;
+  unlock(key);
+}
+
+size_t
+Profiler::stack_used(const uint8_t* bottom, const uint8_t* top)
+{
+  while (bottom < top && *bottom == PAINT) bottom++;
+  return (top - bottom);
+}
+
+size_t
+Profiler::stack_used()
+{
+  extern int __heap_start, *__brkval;
+  const uint8_t* bottom = (__brkval == 0) ?
+    (const uint8_t*) &__heap_start :
+    (const uint8_t*) __brkval;
+  return (stack_used(bottom, (const uint8_t*) RAMEND + 1));
+}
+
+void
+Profiler::print(IOStream& outs)
+{
+  outs << PSTR("profile:stack:used=") << stack_used() << endl;
+  site_t* site = s_site;
+  for (uint8_t i = 0; i < s_sites; i++, site++) {
+    outs << PSTR("profile:lock:") << site->file
+	 << ':' << site->line
+	 << PSTR(":count=") << site->count
+	 << PSTR(",max=") << site->max
+	 << endl;
+  }
+  if (s_dropped != 0)
+    outs << PSTR("profile:lock:dropped=") << s_dropped << endl;
+  for (uint8_t vector = 0; vector < VECTOR_MAX; vector++) {
+    if (s_latency[vector] == 0) continue;
+    outs << PSTR("profile:isr:") << vector
+	 << PSTR(":max=") << s_latency[vector]
+	 << endl;
+  }
+}
+
+/**
+ * Latency probe; the number of cycles from the compare match to the
+ * interrupt handler is the entry latency. Schedule the next probe
+ * with a dither so that the probe is not locked to periodic code.
+ */
+ISR(TIMER1_COMPB_vect)
+{
+  uint16_t cnt = TCNT1;
+  uint16_t match = OCR1B;
+  Profiler::isr_latency(TIMER1_COMPB_vect_num, cnt - match);
+  OCR1B = match + PROBE_PERIOD + (cnt & PROBE_DITHER);
+}
+#endif
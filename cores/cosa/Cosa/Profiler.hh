@@ -0,0 +1,215 @@
+/**
+ * @file Cosa/Profiler.hh
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#ifndef COSA_PROFILER_HH
+#define COSA_PROFILER_HH
+
+#include "Cosa/Types.h"
+#include "Cosa/IOStream.hh"
+
+#if defined(COSA_PROFILE)
+
+#if defined(BOARD_ATTINY)
+#error "Cosa/Profiler.hh: profiling requires a 16-bit Timer1"
+#endif
+
+/**
+ * Number of synchronized block call sites recorded by the profiler.
+ * Default is 16.
+ */
+#ifndef COSA_PROFILE_SITE_MAX
+#define COSA_PROFILE_SITE_MAX 16
+#endif
+
+/**
+ * Runtime profiler; interrupt disabled time per synchronized block,
+ * interrupt entry latency per vector and stack high water mark.
+ * Enabled with COSA_PROFILE (see Cosa.h). All instrumentation is
+ * removed when not enabled and the macros PROFILE_BEGIN(),
+ * PROFILE_ISR() and PROFILE_PRINT() expand to nothing.
+ *
+ * Timer1 is used as a free running cycle counter (no prescale) and
+ * the output compare B interrupt is used as a latency probe. Timer1
+ * may not be used by the application when profiling (e.g. Servo,
+ * Tone and VWI). Measurements are modulo 2**16 cycles (4 ms @ 16
+ * MHz).
+ *
+ * The memory between the heap and the stack is painted at startup.
+ * The stack high water mark is the number of bytes below the end of
+ * memory that have been written. Nucleo threads stacks are within
+ * the main stack and are repainted when started (see
+ * Nucleo::Thread::stack_used()).
+ *
+ * @section Usage
+ * @code
+ * void setup()
+ * {
+ *   ...
+ *   PROFILE_BEGIN();
+ * }
+ * void loop()
+ * {
+ *   ...
+ *   PROFILE_PRINT(trace);
+ * }
+ * ISR(TIMER2_COMPA_vect)
+ * {
+ *   PROFILE_ISR(TIMER2_COMPA_vect_num, TCNT2 * 64);
+ *   ...
+ * }
+ * @endcode
+ */
+class Profiler {
+public:
+  /** Max number of recorded synchronized block call sites. */
+  static const uint8_t SITE_MAX = COSA_PROFILE_SITE_MAX;
+
+  /** Number of interrupt vectors. */
+  static const uint8_t VECTOR_MAX = _VECTORS_SIZE / _VECTOR_SIZE;
+
+  /** Stack paint pattern. */
+  static const uint8_t PAINT = 0xc5;
+
+  /** Synchronized block call site statistics. */
+  struct site_t {
+    str_P file;			//!< Source file name (program memory).
+    uint16_t line;		//!< Source line number.
+    uint16_t count;		//!< Number of calls (saturated).
+    uint16_t max;		//!< Max cycles with interrupts disabled.
+  };
+
+  /**
+   * Start profiler; initiate Timer1 as cycle counter and start the
+   * latency probe. Clears all recorded statistics.
+   */
+  static void begin();
+
+  /**
+   * Stop profiler; stop the latency probe and Timer1.
+   */
+  static void end();
+
+  /**
+   * Return current cycle counter (Timer1).
+   * @return cycles.
+   */
+  static uint16_t cycles()
+    __attribute__((always_inline))
+  {
+    return (TCNT1);
+  }
+
+  /**
+   * Record number of cycles with interrupts disabled for given call
+   * site. Called on exit of profiled synchronized blocks.
+   * @param[in] file source file name (program memory).
+   * @param[in] line source line number.
+   * @param[in] cycles with interrupts disabled.
+   */
+  static void lock_time(str_P file, uint16_t line, uint16_t cycles);
+
+  /**
+   * Record interrupt entry latency for given vector number.
+   * Should be called first in the interrupt service routine.
+   * @param[in] vector number.
+   * @param[in] cycles from interrupt condition to entry.
+   */
+  static void isr_latency(uint8_t vector, uint16_t cycles)
+    __attribute__((always_inline))
+  {
+    if (cycles > s_latency[vector]) s_latency[vector] = cycles;
+  }
+
+  /**
+   * Fill the given memory block with the paint pattern. Used to
+   * repaint a thread stack.
+   * @param[in] bottom of memory block.
+   * @param[in] top of memory block (not included).
+   */
+  static void paint(uint8_t* bottom, uint8_t* top)
+    __attribute__((always_inline))
+  {
+    while (bottom < top) *bottom++ = PAINT;
+  }
+
+  /**
+   * Return number of bytes written in given stack area (high water
+   * mark). The stack grows from top towards bottom.
+   * @param[in] bottom of stack area.
+   * @param[in] top of stack area (not included).
+   * @return number of bytes.
+   */
+  static size_t stack_used(const uint8_t* bottom, const uint8_t* top);
+
+  /**
+   * Return main stack high water mark; number of bytes written from
+   * end of memory (RAMEND) towards the heap.
+   * @return number of bytes.
+   */
+  static size_t stack_used();
+
+  /**
+   * Print profile report to given output stream; main stack high
+   * water mark, synchronized block statistics per call site and
+   * interrupt latency per vector.
+   * @param[in] outs output stream.
+   */
+  static void print(IOStream& outs);
+
+protected:
+  /** Synchronized block call sites. */
+  static site_t s_site[SITE_MAX];
+
+  /** Number of recorded call sites. */
+  static uint8_t s_sites;
+
+  /** Number of call sites that could not be recorded. */
+  static uint16_t s_dropped;
+
+  /** Max interrupt entry latency per vector. */
+  static uint16_t s_latency[VECTOR_MAX];
+};
+
+/**
+ * Start profiler.
+ */
+#define PROFILE_BEGIN() Profiler::begin()
+
+/**
+ * Record interrupt entry latency.
+ * @param[in] vect vector number.
+ * @param[in] cycles since interrupt condition.
+ */
+#define PROFILE_ISR(vect,cycles) Profiler::isr_latency(vect,cycles)
+
+/**
+ * Print profile report.
+ * @param[in] outs output stream.
+ */
+#define PROFILE_PRINT(outs) Profiler::print(outs)
+
+#else
+
+#define PROFILE_BEGIN()
+#define PROFILE_ISR(vect,cycles)
+#define PROFILE_PRINT(outs)
+
+#endif
+#endif
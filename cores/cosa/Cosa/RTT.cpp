@@ -20,6 +20,7 @@
 
 #include "Cosa/RTT.hh"
 #include "Cosa/RTT_Config.hh"
+#include "Cosa/Profiler.hh"
 
 // Initiated state
 bool RTT::s_initiated = false;
@@ -142,6 +143,9 @@ RTT::delay(uint32_t ms)
 
 ISR(TIMERn_COMPA_vect)
 {
+  // Entry latency; the counter is cleared on compare match
+  PROFILE_ISR(TIMERn_COMPA_vect_num, TCNTn * PRESCALE);
+
   // Increment micro-seconds counter (fraction in timer)
   RTT::s_micros += US_PER_TICK;
 
@@ -159,6 +163,9 @@ ISR(TIMERn_COMPA_vect)
 
 ISR(TIMERn_COMPB_vect)
 {
+  // Entry latency from compare match
+  PROFILE_ISR(TIMERn_COMPB_vect_num, ((uint8_t) (TCNTn - OCRnB)) * PRESCALE);
+
   // Disable the timer match
   TIMSKn &= ~_BV(OCIE0B);
 
@@ -46,6 +46,8 @@
 #define TIFRn TIFR2
 #define TIMERn_COMPA_vect TIMER2_COMPA_vect
 #define TIMERn_COMPB_vect TIMER2_COMPB_vect
+#define TIMERn_COMPA_vect_num TIMER2_COMPA_vect_num
+#define TIMERn_COMPB_vect_num TIMER2_COMPB_vect_num
 #elif defined(TCNT0)
 #define timern_enable timer0_enable
 #define timern_disable timer0_disable
@@ -59,5 +61,7 @@
 #define TIFRn TIFR0
 #define TIMERn_COMPA_vect TIMER0_COMPA_vect
 #define TIMERn_COMPB_vect TIMER0_COMPB_vect
+#define TIMERn_COMPA_vect_num TIMER0_COMPA_vect_num
+#define TIMERn_COMPB_vect_num TIMER0_COMPB_vect_num
 #endif
 #endif
@@ -51,7 +51,13 @@ SPI::Driver::Driver(Board::DigitalPin cs, Pulse pulse,
 SPI::SPI() :
   m_list(NULL),
   m_dev(NULL),
-  m_busy(false)
+  m_busy(false),
+  m_first(NULL),
+  m_last(NULL),
+  m_vp(NULL),
+  m_bp(NULL),
+  m_count(0),
+  m_reading(false)
 {
   // Initiate the SPI data direction for master mode
   // The SPI/SS pin must be an output pin in master mode
@@ -290,9 +296,143 @@ SPI::release()
     // Enable all interrupt sources on SPI bus
     for (SPI::Driver* dev = m_list; dev != NULL; dev = dev->m_next)
       if (dev->m_irq != NULL) dev->m_irq->enable();
+#if !defined(USIDR)
+    // Start any pending asynchronous transfer requests
+    if (m_first != NULL) start_request();
+#endif
+  }
+}
+
+#if !defined(USIDR)
+bool
+SPI::submit(Request* req)
+{
+  synchronized {
+    // Check that the request is not already queued
+    if (UNLIKELY(req->m_busy)) return (false);
+
+    // Append to the transfer queue and start if the bus is idle
+    req->m_busy = true;
+    req->m_next = NULL;
+    if (m_last == NULL)
+      m_first = req;
+    else
+      m_last->m_next = req;
+    m_last = req;
+    start_request();
+  }
+  return (true);
+}
+
+void
+SPI::start_request()
+{
+  // Check that there is a request and the bus is not in use
+  if ((m_first == NULL) || m_busy) return;
+
+  // Acquire the bus and disable all interrupt sources on SPI bus
+  m_busy = true;
+  SPI::powerup();
+  for (SPI::Driver* dev = m_list; dev != NULL; dev = dev->m_next)
+    if (dev->m_irq != NULL) dev->m_irq->disable();
+
+  // Start the request
+  complete_request();
+}
+
+bool
+SPI::next_buffer()
+{
+  while (true) {
+    // Find next non-empty buffer in the current io vector
+    if (m_vp != NULL) {
+      for (; m_vp->buf != NULL; m_vp++) {
+	if (m_vp->size == 0) continue;
+	m_bp = (uint8_t*) m_vp->buf;
+	m_count = m_vp->size;
+	m_vp += 1;
+	return (true);
+      }
+    }
+
+    // Continue with the read phase
+    if (m_reading) return (false);
+    m_reading = true;
+    m_vp = m_first->m_rvec;
   }
 }
 
+void
+SPI::complete_request()
+{
+  // Complete the current request (if any); the request is removed
+  // from the queue and the completion event is pushed
+  if (m_dev != NULL) {
+    Request* req = m_first;
+    end();
+    m_first = req->m_next;
+    if (m_first == NULL) m_last = NULL;
+    req->m_next = NULL;
+    req->m_busy = false;
+    m_dev = NULL;
+    if (req->m_target != NULL) {
+      uint8_t type = (req->m_rvec != NULL) ?
+	Event::READ_COMPLETED_TYPE :
+	Event::WRITE_COMPLETED_TYPE;
+      Event::push(type, req->m_target, req);
+    }
+  }
+
+  // Start the next request with the device settings; select the
+  // device and start transfer of the first byte
+  if (m_first != NULL) {
+    Request* req = m_first;
+    m_dev = req->m_dev;
+    SPCR = m_dev->m_spcr;
+    SPSR = m_dev->m_spsr;
+    m_reading = false;
+    m_vp = req->m_wvec;
+    begin();
+    if (next_buffer()) {
+      SPCR |= _BV(SPIE);
+      SPDR = m_reading ? 0xff : *m_bp;
+    }
+    else {
+      // Empty request; complete directly
+      complete_request();
+    }
+    return;
+  }
+
+  // No more requests; release the bus
+  SPCR &= ~_BV(SPIE);
+  release();
+}
+
+void
+SPI::on_interrupt()
+{
+  // Store received data during read phase
+  uint8_t data = SPDR;
+  if (m_reading) *m_bp = data;
+  m_bp += 1;
+
+  // Check for end of buffer and request
+  if ((--m_count == 0) && !next_buffer()) {
+    complete_request();
+    return;
+  }
+
+  // Start transfer of next byte
+  SPDR = m_reading ? 0xff : *m_bp;
+}
+
+ISR(SPI_STC_vect)
+{
+  spi.on_interrupt();
+}
+#endif
+
 void
 SPI::Driver::set_clock(Clock rate)
 {
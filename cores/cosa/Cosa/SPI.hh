@@ -176,6 +176,74 @@ public:
     friend class SPI;
   };
 
+#if !defined(USIDR)
+  /**
+   * Asynchronous SPI transfer request. A request has a write and a
+   * read io buffer vector (null terminated). The write vector is
+   * sent to the device and then data is read from the device into
+   * the read vector. Either vector may be NULL. Requests are
+   * submitted to the SPI transfer queue with SPI::submit() and are
+   * performed back to back by the SPI interrupt handler. The device
+   * chip select is asserted for the duration of the request. On
+   * completion an event (WRITE_COMPLETED_TYPE if no read vector
+   * otherwise READ_COMPLETED_TYPE) is pushed to the target event
+   * handler with the request as value.
+   */
+  class Request {
+  public:
+    /**
+     * Construct SPI transfer request for given device driver with
+     * given write and read io vectors and completion event target.
+     * @param[in] dev device driver.
+     * @param[in] wvec null terminated io vector to write (default null).
+     * @param[in] rvec null terminated io vector to read (default null).
+     * @param[in] target completion event handler (default null).
+     */
+    Request(Driver* dev,
+	    const iovec_t* wvec = NULL,
+	    iovec_t* rvec = NULL,
+	    Event::Handler* target = NULL) :
+      m_next(NULL),
+      m_dev(dev),
+      m_wvec(wvec),
+      m_rvec(rvec),
+      m_target(target),
+      m_busy(false)
+    {}
+
+    /**
+     * Set write and read io vectors. Should not be called while the
+     * request is queued.
+     * @param[in] wvec null terminated io vector to write.
+     * @param[in] rvec null terminated io vector to read (default null).
+     */
+    void vec(const iovec_t* wvec, iovec_t* rvec = NULL)
+    {
+      m_wvec = wvec;
+      m_rvec = rvec;
+    }
+
+    /**
+     * Return true(1) if the request has been completed, i.e. is not
+     * queued or in progress, otherwise false(0).
+     * @return bool.
+     */
+    bool is_completed() const
+    {
+      return (!m_busy);
+    }
+
+  protected:
+    Request* m_next;		//!< Next request in queue.
+    Driver* m_dev;		//!< Device driver.
+    const iovec_t* m_wvec;	//!< Write io vector.
+    iovec_t* m_rvec;		//!< Read io vector.
+    Event::Handler* m_target;	//!< Completion event target.
+    volatile bool m_busy;	//!< Queued or in progress.
+    friend class SPI;
+  };
+#endif
+
   /**
    * Construct serial peripheral interface for master.
    */
@@ -441,10 +509,68 @@ public:
       write(vp->buf, vp->size);
   }
 
+#if !defined(USIDR)
+  /**
+   * Submit given request to the SPI transfer queue. The request is
+   * started directly if the SPI bus is idle, otherwise when previous
+   * requests are completed or the bus is released. Returns true(1)
+   * if successful otherwise false(0) if the request is already
+   * queued.
+   * @param[in] req transfer request.
+   * @return bool.
+   */
+  bool submit(Request* req);
+
+  /**
+   * Wait for given request to complete.
+   * @param[in] req transfer request.
+   */
+  void await(Request* req)
+  {
+    while (!req->is_completed()) yield();
+  }
+#endif
+
 private:
   Driver* m_list;		//!< List of attached device drivers.
   Driver* m_dev;		//!< Current device driver.
   volatile bool m_busy;		//!< Current device state.
+
+#if !defined(USIDR)
+  Request* m_first;		//!< Transfer queue first request.
+  Request* m_last;		//!< Transfer queue last request.
+  const iovec_t* m_vp;		//!< Next io vector in current request.
+  uint8_t* m_bp;		//!< Current buffer pointer.
+  size_t m_count;		//!< Remaining bytes in current buffer.
+  bool m_reading;		//!< Read phase of current request.
+
+  /**
+   * Start the next request in the transfer queue if the SPI bus is
+   * not busy. Should be called with interrupts disabled.
+   */
+  void start_request();
+
+  /**
+   * Advance to the next non-empty buffer in the current request.
+   * Returns true(1) if available otherwise false(0).
+   * @return bool.
+   */
+  bool next_buffer();
+
+  /**
+   * Complete the current request; deselect device, push completion
+   * event and start the next request or release the SPI bus.
+   */
+  void complete_request();
+
+  /**
+   * SPI transfer completed interrupt handler.
+   */
+  void on_interrupt();
+
+  /** Interrupt Service Routine. */
+  friend void SPI_STC_vect(void);
+#endif
 };
 
 /**
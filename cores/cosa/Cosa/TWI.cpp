@@ -33,14 +33,8 @@ TWI twi  __attribute__ ((weak));
 #endif
 
 void
-TWI::acquire(TWI::Driver* dev)
+TWI::enable()
 {
-  // Acquire the device driver. Wait is busy. Synchronized update
-  uint8_t key = lock(m_busy);
-
-  // Set the current device driver
-  m_dev = dev;
-
   // Power up the module
   powerup();
 
@@ -51,6 +45,17 @@ TWI::acquire(TWI::Driver* dev)
   bit_mask_clear(TWSR, _BV(TWPS0) | _BV(TWPS1));
   TWBR = m_freq;
   TWCR = IDLE_CMD;
+}
+
+void
+TWI::acquire(TWI::Driver* dev)
+{
+  // Acquire the device driver. Wait is busy. Synchronized update
+  uint8_t key = lock(m_busy);
+
+  // Set the current device driver and enable the hardware
+  m_dev = dev;
+  enable();
   unlock(key);
 }
 
@@ -60,8 +65,12 @@ TWI::release()
   // Check if an asynchronious read/write was issued
   if (UNLIKELY((m_dev == NULL) || (m_dev->is_async()))) return;
 
-  // Put into idle state
+  // Put into idle state or start queued transactions
   synchronized {
+    if (m_first != NULL) {
+      start();
+      return;
+    }
     m_dev = NULL;
     m_busy = false;
     TWCR = 0;
@@ -71,6 +80,54 @@ TWI::release()
   powerdown();
 }
 
+bool
+TWI::post(Transaction* trans)
+{
+  synchronized {
+    // Check that the transaction is not already queued
+    if (UNLIKELY(trans->m_busy)) return (false);
+    trans->m_busy = true;
+
+    // Append to the bus queue
+    trans->m_next = NULL;
+    if (m_first == NULL)
+      m_first = trans;
+    else
+      m_last_trans->m_next = trans;
+    m_last_trans = trans;
+
+    // Start directly if the bus is idle
+    if (!m_busy) {
+      m_busy = true;
+      enable();
+      start();
+    }
+  }
+  return (true);
+}
+
+void
+TWI::start()
+{
+  // Set the current transaction and device driver
+  Transaction* trans = m_first;
+  m_trans = trans;
+  m_dev = trans->m_dev;
+
+  // Issue write segment (read segment is chained) or read segment
+  iovec_t* vp = m_vec;
+  if (trans->m_write.size != 0) {
+    iovec_arg(vp, trans->m_write.buf, trans->m_write.size);
+    iovec_end(vp);
+    request(WRITE_OP);
+  }
+  else {
+    iovec_arg(vp, trans->m_read.buf, trans->m_read.size);
+    iovec_end(vp);
+    request(READ_OP);
+  }
+}
+
 bool
 TWI::request(uint8_t op)
 {
@@ -154,18 +211,66 @@ TWI::isr_stop(State state, uint8_t type)
 {
   TWCR = TWI::STOP_CMD;
   loop_until_bit_is_clear(TWCR, TWSTO);
+  isr_complete(state, type);
+}
+
+void
+TWI::isr_complete(State state, uint8_t type)
+{
   if (UNLIKELY(state == TWI::ERROR_STATE)) m_count = -1;
   m_state = state;
 
+  // Check for queued transaction; complete and start next
+  Transaction* trans = m_trans;
+  if (trans != NULL) {
+    m_trans = NULL;
+    m_first = trans->m_next;
+    if (m_first == NULL) m_last_trans = NULL;
+    trans->m_count = m_count;
+    trans->m_busy = false;
+    if (UNLIKELY(state == TWI::ERROR_STATE)) type = Event::ERROR_TYPE;
+    Event::push(type, trans, m_count);
+    if (m_first != NULL) {
+      start();
+      return;
+    }
+    m_dev = NULL;
+    m_busy = false;
+    TWCR = 0;
+    return;
+  }
+
   // Check for asynchronous mode and call completion callback
   if (m_dev->is_async() || m_status == SR_STOP) {
     m_dev->on_completion(type, m_count);
+    if ((m_first != NULL) && (m_status != SR_STOP)) {
+      start();
+      return;
+    }
     m_dev = NULL;
     m_busy = false;
     TWCR = 0;
   }
 }
 
+bool
+TWI::isr_chain()
+{
+  // Check for read segment after the write segment
+  Transaction* trans = m_trans;
+  if ((trans == NULL) || (m_state != MT_STATE) || (trans->m_read.size == 0))
+    return (false);
+
+  // Issue repeated start with read operation
+  m_state = MR_STATE;
+  m_addr = (trans->m_dev->m_addr | READ_OP);
+  m_next = (uint8_t*) trans->m_read.buf;
+  m_last = m_next + trans->m_read.size;
+  m_count = 0;
+  TWCR = START_CMD;
+  return (true);
+}
+
 bool
 TWI::isr_write(Command cmd)
 {
@@ -200,8 +305,12 @@ ISR(TWI_vect)
     TWCR = TWI::DATA_CMD;
     break;
   case TWI::ARB_LOST:
-    // Lost arbitration
+    // Lost arbitration; bus is released. Complete queued transaction
     TWCR = TWI::IDLE_CMD;
+    if (twi.m_trans != NULL) {
+      twi.isr_complete(TWI::ERROR_STATE, Event::ERROR_TYPE);
+      break;
+    }
     twi.m_state = TWI::ERROR_STATE;
     twi.m_count = -1;
     break;
@@ -213,6 +322,7 @@ ISR(TWI_vect)
   case TWI::MT_DATA_ACK:
     if (twi.m_next == twi.m_last) twi.isr_start(TWI::MT_STATE, TWI::NEXT_IX);
     if (twi.isr_write(TWI::DATA_CMD)) break;
+    if (twi.isr_chain()) break;
   case TWI::MT_DATA_NACK:
     twi.isr_stop(TWI::IDLE_STATE, Event::WRITE_COMPLETED_TYPE);
     break;
@@ -286,6 +396,21 @@ ISR(TWI_vect)
   }
 }
 
+void
+TWI::Transaction::on_event(uint8_t type, uint16_t value)
+{
+  UNUSED(type);
+  on_completion((int16_t) value);
+}
+
+void
+TWI::Poller::run()
+{
+  Transaction** list = m_list;
+  for (uint8_t i = 0; i < m_count; i++)
+    if (UNLIKELY(!twi.post(*list++))) m_skipped += 1;
+}
+
 void
 TWI::Slave::begin()
 {
@@ -26,13 +26,15 @@
 #include "Cosa/USI/TWI.hh"
 #else
 #include "Cosa/Event.hh"
+#include "Cosa/Periodic.hh"
 #include <avr/power.h>
 
 /**
  * Two wire library. Support for the I2C/TWI bus Master and Slave
  * device drivers. Single-ton, twi, holds bus interaction state.
  * Supporting classes TWI::Driver for device drivers, TWI::Slave
- * for slave devices.
+ * for slave devices, TWI::Transaction for queued asynchronous
+ * requests and TWI::Poller for periodic transaction bursts.
  *
  * @section Circuit
  * TWI slave circuit with internal pullup resistors (4K7). Note that
@@ -199,6 +201,232 @@ public:
     friend void TWI_vect(void);
   };
 
+  /**
+   * Queued bus transaction; an optional write segment followed by an
+   * optional read segment to the given device. When both segments
+   * are given the read segment is chained with a repeated START, i.e.,
+   * the typical register read sequence is performed without releasing
+   * the bus. Transactions are posted to the bus queue with
+   * TWI::post() and performed back to back by the interrupt service
+   * routine. The completion callback, on_completion(), is called
+   * through the event queue.
+   *
+   * @section Usage
+   * @code
+   * class Reading : public TWI::Transaction {
+   * public:
+   *   Reading(TWI::Driver* dev) : TWI::Transaction(dev) {}
+   *   virtual void on_completion(int count) { ... }
+   *   int16_t data[3];
+   * };
+   * Reading sample(&sensor);
+   * ...
+   * sample.write_read(0x32, sample.data, sizeof(sample.data));
+   * twi.post(&sample);
+   * @endcode
+   */
+  class Transaction : public Event::Handler {
+  public:
+    /**
+     * Construct transaction for given device driver.
+     * @param[in] dev device driver (bus address).
+     */
+    Transaction(Driver* dev) :
+      Event::Handler(),
+      m_dev(dev),
+      m_next(NULL),
+      m_reg(0),
+      m_count(0),
+      m_busy(false)
+    {
+      m_write.buf = NULL;
+      m_write.size = 0;
+      m_read.buf = NULL;
+      m_read.size = 0;
+    }
+
+    /**
+     * Set write segment. Zero size for no write segment.
+     * @param[in] buf pointer to buffer.
+     * @param[in] size number of bytes.
+     */
+    void write(void* buf, size_t size)
+    {
+      m_write.buf = buf;
+      m_write.size = size;
+    }
+
+    /**
+     * Set read segment. Zero size for no read segment.
+     * @param[in] buf pointer to buffer.
+     * @param[in] size number of bytes.
+     */
+    void read(void* buf, size_t size)
+    {
+      m_read.buf = buf;
+      m_read.size = size;
+    }
+
+    /**
+     * Set register read sequence; write given register address and
+     * read into given buffer after repeated START.
+     * @param[in] reg register address.
+     * @param[in] buf pointer to buffer.
+     * @param[in] size number of bytes.
+     */
+    void write_read(uint8_t reg, void* buf, size_t size)
+    {
+      m_reg = reg;
+      write(&m_reg, sizeof(m_reg));
+      read(buf, size);
+    }
+
+    /**
+     * Return true(1) if the transaction is queued or in progress
+     * otherwise false(0).
+     * @return bool.
+     */
+    bool is_busy() const
+    {
+      return (m_busy);
+    }
+
+    /**
+     * Return number of bytes of the last segment of the latest
+     * completed transaction or negative error code.
+     * @return number of bytes or negative error code.
+     */
+    int count() const
+    {
+      return (m_count);
+    }
+
+    /**
+     * @override{TWI::Transaction}
+     * Completion callback; called from the event handler when the
+     * transaction has been performed. Count is the number of bytes
+     * of the last segment or negative error code.
+     * @param[in] count number of bytes or negative error code.
+     */
+    virtual void on_completion(int count)
+    {
+      UNUSED(count);
+    }
+
+  protected:
+    /** Device driver; bus address. */
+    Driver* m_dev;
+
+    /** Next transaction in bus queue. */
+    Transaction* volatile m_next;
+
+    /** Write segment. */
+    iovec_t m_write;
+
+    /** Read segment (chained with repeated START). */
+    iovec_t m_read;
+
+    /** Register address for write_read(). */
+    uint8_t m_reg;
+
+    /** Result of latest completed transaction. */
+    int m_count;
+
+    /** Queued or in progress. */
+    volatile bool m_busy;
+
+    /**
+     * @override{Event::Handler}
+     * Record result of completed transaction and call
+     * on_completion().
+     * @param[in] type the event type.
+     * @param[in] value the event value (count).
+     */
+    virtual void on_event(uint8_t type, uint16_t value);
+
+    /** Allow access. */
+    friend class TWI;
+    friend void TWI_vect(void);
+  };
+
+  /**
+   * Periodic bus poller; post a list of transactions to the bus
+   * queue every period. The transactions are performed as a single
+   * burst by the interrupt service routine and completed in list
+   * order. Transactions still in progress from the previous period
+   * are skipped.
+   *
+   * @section Usage
+   * @code
+   * TWI::Transaction* burst[] = { &accelerometer, &gyroscope, &compass };
+   * TWI::Poller poller(&scheduler, 100, burst, membersof(burst));
+   * ...
+   * poller.begin();
+   * @endcode
+   */
+  class Poller : public Periodic {
+  public:
+    /**
+     * Construct poller with given scheduler, period and list of
+     * transactions.
+     * @param[in] scheduler for the periodic job.
+     * @param[in] period in scheduler time unit.
+     * @param[in] list of transactions.
+     * @param[in] count number of transactions in list.
+     */
+    Poller(Job::Scheduler* scheduler, uint32_t period,
+	   Transaction** list, uint8_t count) :
+      Periodic(scheduler, period),
+      m_list(list),
+      m_count(count),
+      m_skipped(0)
+    {}
+
+    /**
+     * Start polling. Post first burst directly.
+     */
+    void begin()
+    {
+      expire_at(time());
+      run();
+      reschedule();
+    }
+
+    /**
+     * Stop polling. Transactions in progress are completed.
+     */
+    void end()
+    {
+      stop();
+    }
+
+    /**
+     * Return number of skipped transactions, i.e., still in progress
+     * when the next period expired.
+     * @return number of skipped transactions.
+     */
+    uint16_t skipped() const
+    {
+      return (m_skipped);
+    }
+
+    /**
+     * @override{Job}
+     * Post the list of transactions to the bus queue.
+     */
+    virtual void run();
+
+  protected:
+    /** List of transactions. */
+    Transaction** m_list;
+
+    /** Number of transactions in list. */
+    uint8_t m_count;
+
+    /** Number of skipped transactions. */
+    uint16_t m_skipped;
+  };
+
   /**
    * Construct two-wire instance. This is actually a single-ton on
    * current supported hardware, i.e. there can only be one unit.
@@ -211,6 +439,9 @@ public:
     m_last(NULL),
     m_count(0),
     m_dev(NULL),
+    m_trans(NULL),
+    m_first(NULL),
+    m_last_trans(NULL),
     m_freq(((F_CPU / DEFAULT_FREQ) - 16) / 2),
     m_busy(false)
   {
@@ -233,6 +464,17 @@ public:
    */
   void release();
 
+  /**
+   * Post given transaction to the bus queue. The transaction is
+   * started directly if the bus is idle otherwise when the current
+   * transaction or driver access block has completed. Return true(1)
+   * if queued otherwise false(0); the transaction is already queued or
+   * in progress. May be called from an interrupt service routine.
+   * @param[in] trans transaction.
+   * @return bool.
+   */
+  bool post(Transaction* trans);
+
   /**
    * Issue a write data request to the current driver. Return
    * true(1) if successful otherwise false(0).
@@ -468,6 +710,9 @@ private:
   volatile int m_count;
   uint8_t m_addr;
   Driver* m_dev;
+  Transaction* m_trans;
+  Transaction* m_first;
+  Transaction* m_last_trans;
   uint8_t m_freq;
   volatile bool m_busy;
 
@@ -504,6 +749,37 @@ private:
    */
   void isr_stop(State state, uint8_t type = Event::NULL_TYPE);
 
+  /**
+   * Complete current transfer in given state without generating stop
+   * condition; used directly when arbitration is lost. Completes
+   * queued transaction or calls the device completion callback and
+   * starts the next queued transaction. Part of the TWI ISR state
+   * machine.
+   * @param[in] state to step to.
+   * @param[in] type of event to push (default no event).
+   */
+  void isr_complete(State state, uint8_t type = Event::NULL_TYPE);
+
+  /**
+   * Chain the read segment of the current transaction with a repeated
+   * START. Return true(1) if chained otherwise false(0). Part of the
+   * TWI ISR state machine.
+   * @return bool
+   */
+  bool isr_chain();
+
+  /**
+   * Enable TWI hardware in master mode; power up, pullup and bus
+   * clock.
+   */
+  void enable();
+
+  /**
+   * Start the first transaction in the bus queue. The bus must be
+   * acquired.
+   */
+  void start();
+
   /**
    * Initiate a request to the device. Return true(1) if successful
    * otherwise false(0).
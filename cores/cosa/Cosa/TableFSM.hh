@@ -0,0 +1,259 @@
+/**
+ * @file Cosa/TableFSM.hh
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#ifndef COSA_TABLE_FSM_HH
+#define COSA_TABLE_FSM_HH
+
+#include "Cosa/Job.hh"
+#include "Cosa/Event.hh"
+
+/**
+ * Table driven Finite State Machine. The states, events, guards,
+ * actions and transitions are declared at compile time as a flat
+ * transition table [state][event] in program memory. Dispatch of an
+ * event is a table lookup and (optional) guard and action call. No
+ * state machine data other than the current state and timer is
+ * stored in data memory. Supports timeout events and period timed
+ * state machines as FSM.
+ *
+ * Events are numbered from zero and the event number is the column
+ * in the transition table. Event zero (TIMEOUT) is the timeout event.
+ * Events are sent through the event queue with send(), as user
+ * defined event types (Event::USER_TYPE + event), or dispatched
+ * directly with dispatch().
+ *
+ * @param[in] T state machine class (derived).
+ * @param[in] STATE_MAX number of states.
+ * @param[in] EVENT_MAX number of events.
+ *
+ * @section Usage
+ * @code
+ * class Blink : public TableFSM<Blink, 2, 1> {
+ * public:
+ *   enum { OFF, ON };
+ *   Blink() : TableFSM(table, OFF, &scheduler, 500) {}
+ *   static void on(Blink* fsm, uint16_t value);
+ *   static void off(Blink* fsm, uint16_t value);
+ *   static const table_t table PROGMEM;
+ * };
+ * const Blink::table_t Blink::table PROGMEM = {
+ *   { FSM_TRANSITION(ON, NULL, Blink::on) },
+ *   { FSM_TRANSITION(OFF, NULL, Blink::off) }
+ * };
+ * @endcode
+ */
+template<class T, uint8_t STATE_MAX, uint8_t EVENT_MAX>
+class TableFSM : protected Job {
+public:
+  /** Timeout event number. */
+  static const uint8_t TIMEOUT = 0;
+
+  /**
+   * Transition guard function prototype. Should return true(1) if
+   * the transition is allowed otherwise false(0).
+   * @param[in] fsm finite state machine.
+   * @param[in] value the event value.
+   * @return bool.
+   */
+  typedef bool (*Guard)(T* fsm, uint16_t value);
+
+  /**
+   * Transition action function prototype.
+   * @param[in] fsm finite state machine.
+   * @param[in] value the event value.
+   */
+  typedef void (*Action)(T* fsm, uint16_t value);
+
+  /**
+   * Transition table entry. Use FSM_TRANSITION() to define entries.
+   * Entries that are not defined (zero) ignore the event.
+   */
+  struct transition_t {
+    uint8_t next;		//!< Next state plus one (zero ignore).
+    Guard guard;		//!< Transition guard (or NULL).
+    Action action;		//!< Transition action (or NULL).
+  };
+
+  /** Transition table; [state][event] in program memory. */
+  typedef transition_t table_t[STATE_MAX][EVENT_MAX];
+
+  /**
+   * Construct state machine with given transition table and initial
+   * state.
+   * @param[in] table transition table (program memory).
+   * @param[in] init initial state.
+   * @param[in] scheduler for timeout handling (default no timout handling).
+   * @param[in] period timeout in all states (default no timeout).
+   */
+  TableFSM(const table_t& table, uint8_t init,
+	   Job::Scheduler* scheduler = NULL, uint16_t period = 0) :
+    Job(scheduler),
+    m_table(table),
+    m_state(init),
+    m_period(period)
+  {}
+
+  /**
+   * Set new state for next event.
+   * @param[in] state next state.
+   */
+  void state(uint8_t state)
+    __attribute__((always_inline))
+  {
+    if (UNLIKELY(state >= STATE_MAX)) return;
+    m_state = state;
+  }
+
+  /**
+   * Get current state.
+   * @return state.
+   */
+  uint8_t state() const
+    __attribute__((always_inline))
+  {
+    return (m_state);
+  }
+
+  /**
+   * Set timeout period for all states.
+   * @param[in] ms timeout.
+   */
+  void period(uint16_t ms)
+  {
+    m_period = ms;
+  }
+
+  /**
+   * Send an event to the state machine through the event queue.
+   * @param[in] event number.
+   * @param[in] value the event value.
+   */
+  void send(uint8_t event, uint16_t value = 0)
+    __attribute__((always_inline))
+  {
+    Event::push(Event::USER_TYPE + event, this, value);
+  }
+
+  /**
+   * Dispatch an event directly to the state machine. Lookup the
+   * transition for the current state and event. Check guard, perform
+   * state transition and action. Return true(1) if the transition
+   * was performed otherwise false(0).
+   * @param[in] event number.
+   * @param[in] value the event value.
+   * @return bool.
+   */
+  bool dispatch(uint8_t event, uint16_t value = 0)
+  {
+    if (UNLIKELY(event >= EVENT_MAX)) return (false);
+    const transition_t* tp = &m_table[m_state][event];
+    uint8_t next = pgm_read_byte(&tp->next);
+    if (next == 0) return (false);
+    Guard guard = (Guard) pgm_read_word(&tp->guard);
+    if ((guard != NULL) && !guard(static_cast<T*>(this), value))
+      return (false);
+    Action action = (Action) pgm_read_word(&tp->action);
+    m_state = next - 1;
+    if (action != NULL) action(static_cast<T*>(this), value);
+    return (true);
+  }
+
+  /**
+   * Start the state machine period timer (if defined).
+   */
+  bool begin()
+  {
+    if ((m_period != 0) && (m_period != TIMEOUT_REQUEST)) {
+      expire_after(m_period);
+      start();
+    }
+    return (true);
+  }
+
+  /**
+   * Stop the state machine timer.
+   */
+  void end()
+  {
+    cancel_timer();
+  }
+
+  /**
+   * Set timer for time out events and possible state transitions.
+   * @param[in] ms timeout period.
+   */
+  void set_timer(uint16_t ms)
+    __attribute__((always_inline))
+  {
+    m_period = TIMEOUT_REQUEST;
+    expire_after(ms);
+    start();
+  }
+
+  /**
+   * Cancel a timer request.
+   */
+  void cancel_timer()
+    __attribute__((always_inline))
+  {
+    if (UNLIKELY(m_period == 0)) return;
+    stop();
+    m_period = 0;
+  }
+
+private:
+  static const uint16_t TIMEOUT_REQUEST = 0xffff;
+  const transition_t (*m_table)[EVENT_MAX];
+  uint8_t m_state;
+  uint16_t m_period;
+
+  /**
+   * @override{Event::Handler}
+   * Map timeout and user defined event types to event numbers and
+   * dispatch. Restart period timer on timeout.
+   * @param[in] type the type of event.
+   * @param[in] value the event value.
+   */
+  virtual void on_event(uint8_t type, uint16_t value)
+  {
+    if (type == Event::TIMEOUT_TYPE) {
+      dispatch(TIMEOUT, value);
+      if ((m_period != 0) && (m_period != TIMEOUT_REQUEST)) {
+	expire_after(m_period);
+	start();
+      }
+    }
+    else if (type >= Event::USER_TYPE) {
+      dispatch(type - Event::USER_TYPE, value);
+    }
+  }
+};
+
+/**
+ * Define transition table entry with given next state, guard and
+ * action function.
+ * @param[in] next state.
+ * @param[in] guard function (or NULL).
+ * @param[in] action function (or NULL).
+ */
+#define FSM_TRANSITION(next,guard,action)		\
+  { (next) + 1, guard, action }
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file Cosa/TimerWheel.hh
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#ifndef COSA_TIMER_WHEEL_HH
+#define COSA_TIMER_WHEEL_HH
+
+#include "Cosa/Types.h"
+#include "Cosa/Job.hh"
+
+/**
+ * Hashed timer wheel for job schedulers. The wheel is plugged on top
+ * of an existing scheduler class (e.g. Watchdog::Scheduler or
+ * RTT::Scheduler) and keeps jobs that will expire later than one
+ * slot period in a number of unsorted slot queues. Starting and
+ * stopping a job is O(1) with only a few instructions executed with
+ * interrupts disabled. Jobs are moved to the sorted queue of the
+ * underlying scheduler when they are within one slot period of
+ * expiring. The underlying queue will therefore only hold a few jobs
+ * and insert is short.
+ *
+ * The time span of a slot is 2**SHIFT scheduler time units and a
+ * wheel revolution is SLOTS slots. Jobs with longer expire times
+ * remain in their slot for several revolutions. Select the slot
+ * span close to the tick of the scheduler (e.g. 16 ms for the
+ * watchdog and 1024 us for RTT) and the number of slots so that
+ * a revolution covers the typical job period.
+ *
+ * @param[in] SCHEDULER job scheduler class.
+ * @param[in] SLOTS number of slots in wheel.
+ * @param[in] SHIFT log2 slot span in scheduler time unit.
+ * @pre SLOTS is powerof(2) and max 128.
+ *
+ * @section Usage
+ * @code
+ * // Watchdog scheduler with 16 ms slots and 256 ms revolution
+ * TimerWheel<Watchdog::Scheduler, 16, 4> scheduler;
+ * // RTT scheduler with 1024 us slots and 32 ms revolution
+ * TimerWheel<RTT::Scheduler, 32, 10> scheduler;
+ * @endcode
+ */
+template<class SCHEDULER, uint8_t SLOTS = 16, uint8_t SHIFT = 4>
+class TimerWheel : public SCHEDULER {
+  static_assert(SLOTS && !(SLOTS & (SLOTS - 1)), "SLOTS should be power of 2");
+  static_assert(SLOTS <= 128, "SLOTS should be max 128");
+public:
+  /**
+   * Construct timer wheel on top of given scheduler class.
+   */
+  TimerWheel() :
+    SCHEDULER(),
+    m_cursor(0)
+  {}
+
+  /**
+   * @override{Job::Scheduler}
+   * Start given job. Jobs that expire within a slot period are
+   * passed on to the underlying scheduler otherwise the job is
+   * hashed to a slot on the wheel. Returns true(1) if successful
+   * otherwise false(0).
+   * @param[in] job to start.
+   * @return bool.
+   */
+  virtual bool start(Job* job);
+
+  /**
+   * @override{Job::Scheduler}
+   * Dispatch expired jobs. Move jobs in the slots from the latest
+   * dispatch to the current time that will expire within a slot
+   * period to the underlying scheduler, and dispatch its queue.
+   */
+  virtual void dispatch();
+
+protected:
+  /** Slot index mask. */
+  static const uint8_t MASK = (SLOTS - 1);
+
+  /** Slot time span. */
+  static const uint32_t SPAN = (1UL << SHIFT);
+
+  /** Slot queues. */
+  Head m_slot[SLOTS];
+
+  /** Next slot tick to scan. */
+  uint32_t m_cursor;
+};
+
+template<class SCHEDULER, uint8_t SLOTS, uint8_t SHIFT>
+bool
+TimerWheel<SCHEDULER,SLOTS,SHIFT>::start(Job* job)
+{
+  // Check that the job is not already started
+  if (job->is_started()) return (false);
+
+  // Hash the job to the wheel. The time check and attach must be
+  // atomic so that the slot is not passed by the dispatch
+  synchronized {
+    int32_t diff = job->expire_at() - this->time();
+    if (diff >= (int32_t) SPAN) {
+      m_slot[(uint8_t) (job->expire_at() >> SHIFT) & MASK].attach(job);
+      return (true);
+    }
+  }
+
+  // Or pass to the scheduler queue if it expires within a slot period
+  return (SCHEDULER::start(job));
+}
+
+template<class SCHEDULER, uint8_t SLOTS, uint8_t SHIFT>
+void
+TimerWheel<SCHEDULER,SLOTS,SHIFT>::dispatch()
+{
+  // Scan the slots from the cursor to the next slot, max one revolution
+  uint32_t now = this->time();
+  uint32_t tick = (now >> SHIFT) + 1;
+  uint32_t count = tick - m_cursor + 1;
+  if (count > SLOTS) count = SLOTS;
+  uint8_t ix = (uint8_t) (tick - count + 1) & MASK;
+  while (count--) {
+    Head* slot = &m_slot[ix];
+    Linkage* link = slot->succ();
+    while (link != slot) {
+      Linkage* succ = link->succ();
+      Job* job = (Job*) link;
+      int32_t diff = job->expire_at() - now;
+      if (diff < (int32_t) SPAN) {
+	job->detach();
+	SCHEDULER::start(job);
+      }
+      link = succ;
+    }
+    ix = (ix + 1) & MASK;
+  }
+  m_cursor = tick;
+
+  // Dispatch expired jobs in the scheduler queue
+  SCHEDULER::dispatch();
+}
+
+#endif
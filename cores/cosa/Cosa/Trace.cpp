@@ -19,6 +19,7 @@
  */
 
 #include "Cosa/Trace.hh"
+#include "Cosa/RTT.hh"
 
 Trace trace __attribute__ ((weak));
 
@@ -43,3 +44,31 @@ Trace::fatal(const char* file, int line, str_P expr)
   device()->flush();
   exit(0);
 }
+
+#if defined(COSA_MEASURE_CYCLES)
+void
+Trace::cycles_start()
+{
+  // Start timer1 as free running counter with clock (no prescale)
+  if (TCCR1B != _BV(CS10)) {
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);
+    TIMSK1 = 0;
+  }
+  m_start_us = RTT::micros();
+  m_start_cycles = TCNT1;
+}
+
+uint32_t
+Trace::cycles_stop()
+{
+  uint16_t cycles = TCNT1 - m_start_cycles;
+  measure = RTT::micros() - m_start_us;
+
+  // Add the number of counter wrap-arounds; nearest to elapsed time
+  uint32_t estimate = measure * (F_CPU / 1000000L);
+  if (estimate > cycles)
+    return (cycles + ((estimate - cycles + 0x8000UL) & 0xffff0000UL));
+  return (cycles);
+}
+#endif
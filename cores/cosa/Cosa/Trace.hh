@@ -24,6 +24,11 @@
 #include "Cosa/Types.h"
 #include "Cosa/IOStream.hh"
 
+// Cycle count measurement requires timer1 (not available on ATtiny)
+#if defined(BOARD_ATTINY)
+#undef COSA_MEASURE_CYCLES
+#endif
+
 /**
  * Basic trace support class. Combind IOStream with UART for trace
  * output.
@@ -79,7 +84,33 @@ public:
   /** Result of latest MEASURE (in micro-seconds). */
   uint32_t measure;
 
+#if defined(COSA_MEASURE_CYCLES)
+  /**
+   * Start cycle count measurement. Timer1 is used as a free running
+   * clock cycle counter and must not be used by the sketch. Used by
+   * MEASURE when built with COSA_MEASURE_CYCLES (simulation).
+   */
+  void cycles_start();
+
+  /**
+   * Stop cycle count measurement and return number of clock cycles
+   * since cycles_start(). The wrap-around of the 16-bit counter is
+   * resolved with RTT::micros(). The elapsed time (micro-seconds)
+   * is stored in measure.
+   * @return number of clock cycles.
+   */
+  uint32_t cycles_stop();
+#endif
+
 protected:
+#if defined(COSA_MEASURE_CYCLES)
+  /** Micro-seconds at cycles_start(). */
+  uint32_t m_start_us;
+
+  /** Timer1 counter at cycles_start(). */
+  uint16_t m_start_cycles;
+#endif
+
   /** Exit from serial monitor, miniterm. Default CTRL-ALT GR-] (0x1d) */
   char EXITCHARACTER;
 };
@@ -213,6 +244,10 @@ extern uint8_t trace_log_mask;
  * @endcode
  * @param[in] msg measurement prefix string.
  * @param[in] cnt number of block calls (max UINT16_MAX).
+ *
+ * When built with COSA_MEASURE_CYCLES the MEASURE result is printed
+ * as clock cycles per block call (measure is still micro-seconds).
+ * Intended for cycle accurate simulation, see build/simulate.
  */
 # if defined(TRACE_NO_VERBOSE) || defined(BOARD_ATTINY)
 # define MEASURE(msg,cnt)						\
@@ -237,6 +272,31 @@ extern uint8_t trace_log_mask;
        trace << PSTR(" ms") << endl,					\
        trace.flush())							\
     for (uint16_t __j = cnt; __j != 0; __j--)
+#elif defined(COSA_MEASURE_CYCLES)
+# define MEASURE(msg,cnt)						\
+  trace.flush();							\
+  for (uint32_t __cycles, __i = (trace.cycles_start(), 1);		\
+       __i != 0;							\
+       __i--,								\
+       __cycles = trace.cycles_stop() / cnt,				\
+       trace.measure /= cnt,						\
+       trace << __LINE__ << ':' << __PRETTY_FUNCTION__,			\
+       trace << PSTR(":measure:") << PSTR(msg) << __cycles,		\
+       trace << PSTR(" cycles") << endl,				\
+       trace.flush())							\
+    for (uint16_t __j = cnt; __j != 0; __j--)
+# define measure(msg,cnt)						\
+  trace.flush();							\
+  for (uint32_t __stop, __start = RTT::millis(), __i = 1;		\
+       __i != 0;							\
+       __i--,								\
+       __stop = RTT::millis(),						\
+       trace.measure = (__stop - __start) / cnt,			\
+       trace << __LINE__ << ':' << __PRETTY_FUNCTION__,			\
+       trace << PSTR(":measure:") << PSTR(msg) << trace.measure,	\
+       trace << PSTR(" ms") << endl,					\
+       trace.flush())							\
+    for (uint16_t __j = cnt; __j != 0; __j--)
 #else
 # define MEASURE(msg,cnt)						\
   trace.flush();							\
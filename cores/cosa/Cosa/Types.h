@@ -356,10 +356,38 @@ inline void __unlock(uint8_t* key)
  * @endcode
  * Interrupts are disabled in the block allowing secure update.
  * All control structures are allowed (e.g. return, goto).
+ * When profiling (COSA_PROFILE) the number of cycles with interrupts
+ * disabled is recorded per block, see Cosa/Profiler.hh.
  */
+#if defined(COSA_PROFILE)
+/**
+ * Profiled synchronized block state; processor flags, start cycle
+ * and call site (file and line).
+ */
+struct __profile_key_t {
+  uint8_t key;
+  uint16_t start;
+  str_P file;
+  uint16_t line;
+};
+
+/**
+ * Restore processor flags and record the number of cycles with
+ * interrupts disabled for the call site. Internal clean up function
+ * for profiled synchronized block. Defined in Cosa/Profiler.cpp.
+ * @param[in] key profile key.
+ */
+extern void __profile_unlock(__profile_key_t* key);
+
+#define synchronized							\
+  for (__profile_key_t __key __attribute__((__cleanup__(__profile_unlock))) \
+	 = { lock(), TCNT1, PSTR(__FILE__), __LINE__ }, *i = &__key;	\
+       i != NULL; i = NULL)
+#else
 #define synchronized							\
   for (uint8_t __key __attribute__((__cleanup__(__unlock))) = lock(),	\
        i = 1; i != 0; i--)
+#endif
 
 /**
  * Conditional variable.
@@ -126,6 +126,56 @@ UART::putchar(char c)
   return (c & 0xff);
 }
 
+int
+UART::write(const void* buf, size_t size)
+{
+  const char* bp = (const char*) buf;
+  size_t n = size;
+  if (UNLIKELY(n == 0)) return (0);
+
+  // Start the transmitter with the first character (fast track)
+  putchar(*bp++);
+  n -= 1;
+
+  // Move blocks to the output buffer and enable the transmitter
+  while (n != 0) {
+    int res = m_obuf->write(bp, n);
+    if (res <= 0) {
+      yield();
+      continue;
+    }
+    *UCSRnB() |= _BV(UDRIE0);
+    bp += res;
+    n -= res;
+  }
+  return (size);
+}
+
+int
+UART::write_P(const void* buf, size_t size)
+{
+  const char* bp = (const char*) buf;
+  size_t n = size;
+  if (UNLIKELY(n == 0)) return (0);
+
+  // Start the transmitter with the first character (fast track)
+  putchar(pgm_read_byte(bp++));
+  n -= 1;
+
+  // Move blocks to the output buffer and enable the transmitter
+  while (n != 0) {
+    int res = m_obuf->write_P(bp, n);
+    if (res <= 0) {
+      yield();
+      continue;
+    }
+    *UCSRnB() |= _BV(UDRIE0);
+    bp += res;
+    n -= res;
+  }
+  return (size);
+}
+
 int
 UART::flush()
 {
@@ -220,7 +270,10 @@ UART::on_udre_interrupt()
 void
 UART::on_rx_interrupt()
 {
-  m_ibuf->putchar(*UDRn());
+  // Drain the receiver; the hardware buffer may hold more than one
+  do {
+    m_ibuf->putchar(*UDRn());
+  } while (*UCSRnA() & _BV(RXC0));
 }
 
 #define UART_ISR(vec,nr)			\
@@ -108,6 +108,48 @@ public:
    */
   virtual int putchar(char c);
 
+  /** Overloaded virtual member function write. */
+  using IOStream::Device::write;
+
+  /** Overloaded virtual member function read. */
+  using IOStream::Device::read;
+
+  /**
+   * @override{IOStream::Device}
+   * Write data from buffer with given size to serial port output
+   * buffer. The data is moved to the output buffer in blocks. Will
+   * yield while the output buffer is full. Returns number of bytes
+   * written.
+   * @param[in] buf buffer to write.
+   * @param[in] size number of bytes to write.
+   * @return number of bytes written.
+   */
+  virtual int write(const void* buf, size_t size);
+
+  /**
+   * @override{IOStream::Device}
+   * Write data from buffer in program memory with given size to
+   * serial port output buffer. Will yield while the output buffer is
+   * full. Returns number of bytes written.
+   * @param[in] buf buffer in program memory to write.
+   * @param[in] size number of bytes to write.
+   * @return number of bytes written.
+   */
+  virtual int write_P(const void* buf, size_t size);
+
+  /**
+   * @override{IOStream::Device}
+   * Read data to given buffer with given size from serial port input
+   * buffer. Returns number of bytes read.
+   * @param[in] buf buffer to read into.
+   * @param[in] size number of bytes to read.
+   * @return number of bytes read.
+   */
+  virtual int read(void* buf, size_t size)
+  {
+    return (m_ibuf->read(buf, size));
+  }
+
   /**
    * @override{IOStream::Device}
    * Peek at next character from serial port input buffer. Returns
@@ -22,7 +22,8 @@
  * for each received event sends an event to a connected machine.
  * The measurement contains the pushing of the event onto the event
  * queue, pulling and dispatch of the event to the receiving state
- * machine.
+ * machine. The same benchmark is performed with table driven state
+ * machines (TableFSM) and with direct dispatch of events.
  *
  * @section Circuit
  * This example requires no special circuit. Uses serial output,
@@ -32,6 +33,7 @@
  */
 
 #include "Cosa/FSM.hh"
+#include "Cosa/TableFSM.hh"
 #include "Cosa/Memory.h"
 #include "Cosa/RTT.hh"
 #include "Cosa/Watchdog.hh"
@@ -74,9 +76,54 @@ private:
   FSM* m_port;
 };
 
+/**
+ * Table driven echo state machine with a single state.
+ */
+class TableEcho : public TableFSM<TableEcho, 1, 2> {
+public:
+  /** Echo event number. */
+  static const uint8_t ECHO = 1;
+
+  /**
+   * Construct the table driven echo state machine.
+   */
+  TableEcho() : TableFSM(table, 0), m_port(NULL) {}
+
+  /**
+   * Bind receiving fsm to port.
+   * @param[in] fsm state machine to receive the event (or NULL).
+   */
+  void bind(TableEcho* fsm)
+  {
+    m_port = fsm;
+  }
+
+  /**
+   * The echo action; send a reply if bound.
+   */
+  static void echo(TableEcho* fsm, uint16_t value)
+  {
+    UNUSED(value);
+    if (fsm->m_port != NULL) fsm->m_port->send(ECHO);
+  }
+
+  /** Transition table. */
+  static const table_t table PROGMEM;
+
+private:
+  /** Port (pointer) to receiving state-machine */
+  TableEcho* m_port;
+};
+
+const TableEcho::table_t TableEcho::table PROGMEM = {
+  { FSM_TRANSITION(0, NULL, NULL), FSM_TRANSITION(0, NULL, TableEcho::echo) }
+};
+
 // The ping-pong state machines
 Echo ping;
 Echo pong;
+TableEcho tping;
+TableEcho tpong;
 
 void setup()
 {
@@ -92,6 +139,7 @@ void setup()
   TRACE(sizeof(Link));
   TRACE(sizeof(FSM));
   TRACE(sizeof(Echo));
+  TRACE(sizeof(TableEcho));
 
   // Give some more startup info
   TRACE(F_CPU);
@@ -104,19 +152,36 @@ void setup()
   // Bind the state machines to each other
   ping.bind(&pong);
   pong.bind(&ping);
-
-  // Send a first event to start the benchmark
-  ping.send(Event::USER_TYPE);
+  tping.bind(&tpong);
+  tpong.bind(&tping);
 }
 
 void loop()
 {
+  Event event;
+
   // Dispatch events and measure time per dispatch
+  ping.send(Event::USER_TYPE);
   MEASURE("event dispatch: ", 1000) {
-    Event event;
     Event::queue.await(&event);
     event.dispatch();
   }
+  Event::queue.dequeue(&event);
+
+  // Dispatch events to the table driven state machines
+  tping.send(TableEcho::ECHO);
+  MEASURE("table event dispatch: ", 1000) {
+    Event::queue.await(&event);
+    event.dispatch();
+  }
+  Event::queue.dequeue(&event);
+
+  // Direct dispatch to table driven state machine
+  tping.bind(NULL);
+  MEASURE("table direct dispatch: ", 1000) {
+    tping.dispatch(TableEcho::ECHO);
+  }
+  tping.bind(&tpong);
 
   // Run the loop a limited number of times
   static uint8_t count = 0;
@@ -0,0 +1,159 @@
+/**
+ * @file CosaBenchmarkJob.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Cosa Job Scheduler Benchmark; compare the default sorted list job
+ * scheduler with the timer wheel. The benchmark measures the number
+ * of micro-seconds for start/stop of a job and dispatch with JOB_MAX
+ * jobs already started. The worst case start time of the list
+ * scheduler is when the job expires before all other jobs as the
+ * whole queue is scanned with interrupts disabled.
+ *
+ * @section Circuit
+ * This example requires no special circuit. Uses serial output.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Cosa/Job.hh"
+#include "Cosa/TimerWheel.hh"
+#include "Cosa/Memory.h"
+#include "Cosa/RTT.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/UART.hh"
+
+// Number of started jobs in each scheduler
+#define JOB_MAX 40
+
+/**
+ * Job scheduler with milli-seconds time base. Not registered so
+ * jobs are only dispatched by the benchmark.
+ */
+class Scheduler : public Job::Scheduler {
+public:
+  virtual uint32_t time()
+  {
+    return (RTT::millis());
+  }
+};
+
+/**
+ * Job with settable scheduler so that arrays may be used.
+ */
+class Worker : public Job {
+public:
+  Worker() : Job(NULL) {}
+
+  void scheduler(Job::Scheduler* scheduler)
+  {
+    m_scheduler = scheduler;
+  }
+};
+
+Scheduler list;
+TimerWheel<Scheduler, 16, 4> wheel;
+
+Worker list_job[JOB_MAX];
+Worker wheel_job[JOB_MAX];
+Worker probe;
+
+/**
+ * Start given number of jobs on the scheduler with expire times
+ * after the probe job.
+ * @param[in] scheduler to start jobs on.
+ * @param[in] job vector.
+ */
+void populate(Job::Scheduler* scheduler, Worker* job)
+{
+  uint32_t now = RTT::millis();
+  for (uint8_t i = 0; i < JOB_MAX; i++) {
+    job[i].scheduler(scheduler);
+    job[i].expire_at(now + 10000 + i * 50);
+    job[i].start();
+  }
+}
+
+/**
+ * Measure worst case start time (i.e. interrupt off time) for the
+ * given scheduler. The probe job expires before all the started jobs.
+ * @param[in] scheduler to measure.
+ * @return max micro-seconds.
+ */
+uint32_t worst_case(Job::Scheduler* scheduler)
+{
+  uint32_t max = 0;
+  probe.scheduler(scheduler);
+  for (uint16_t i = 0; i < 1000; i++) {
+    probe.expire_at(RTT::millis() + 5000);
+    uint32_t start = RTT::micros();
+    probe.start();
+    uint32_t us = RTT::micros() - start;
+    probe.stop();
+    if (us > max) max = us;
+  }
+  return (max);
+}
+
+void setup()
+{
+  // Start the trace output stream on the serial port
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaBenchmarkJob: started"));
+
+  // Check amount of free memory and size of instances
+  TRACE(free_memory());
+  TRACE(sizeof(Job));
+  TRACE(sizeof(list));
+  TRACE(sizeof(wheel));
+
+  // Print CPU clock and instructions per 1MHZ
+  TRACE(F_CPU);
+  TRACE(I_CPU);
+
+  // Start the timer and populate the schedulers
+  RTT::begin();
+  populate(&list, list_job);
+  populate(&wheel, wheel_job);
+  TRACE(JOB_MAX);
+
+  // Measure start/stop time with the probe job expiring first
+  probe.scheduler(&list);
+  MEASURE("list:start/stop: ", 1000) {
+    probe.expire_at(RTT::millis() + 5000);
+    probe.start();
+    probe.stop();
+  }
+  probe.scheduler(&wheel);
+  MEASURE("wheel:start/stop: ", 1000) {
+    probe.expire_at(RTT::millis() + 5000);
+    probe.start();
+    probe.stop();
+  }
+
+  // Measure dispatch time with no expired jobs
+  MEASURE("list:dispatch: ", 1000) list.dispatch();
+  MEASURE("wheel:dispatch: ", 1000) wheel.dispatch();
+
+  // Measure worst case start time (interrupt off time)
+  INFO("list:max start: %ul us", worst_case(&list));
+  INFO("wheel:max start: %ul us", worst_case(&wheel));
+}
+
+void loop()
+{
+  ASSERT(true == false);
+}
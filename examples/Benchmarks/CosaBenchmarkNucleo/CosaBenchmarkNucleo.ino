@@ -0,0 +1,160 @@
+/**
+ * @file CosaBenchmarkNucleo.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Cosa Nucleo Thread scheduling latency benchmark. A radio thread
+ * waits on a semaphore signaled by a probe thread while a number of
+ * user interface threads are busy and yield. The benchmark measures
+ * the time from signal to radio thread wakeup with the radio thread
+ * on the same priority as the user interface threads and on the
+ * highest priority. Runs under simulation (cosa uno sim).
+ *
+ * @section Circuit
+ * This example requires no special circuit. Uses serial output.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include <Nucleo.h>
+
+#include "Cosa/RTT.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/Watchdog.hh"
+#include "Cosa/UART.hh"
+
+// Number of user interface threads and busy time per yield (us)
+#define UI_MAX 3
+#define UI_BUSY 200
+
+// Number of samples per measurement
+#define SAMPLES 100
+
+Nucleo::Semaphore irq(0);
+volatile uint32_t stamp = 0L;
+uint32_t latency_max = 0L;
+uint32_t latency_sum = 0L;
+
+/**
+ * Radio thread; waits for signal and records the wakeup latency.
+ */
+class Radio : public Nucleo::Thread {
+public:
+  virtual void run()
+  {
+    while (1) {
+      irq.wait();
+      uint32_t us = RTT::micros() - stamp;
+      if (us > latency_max) latency_max = us;
+      latency_sum += us;
+    }
+  }
+};
+
+/**
+ * User interface thread; busy and yield.
+ */
+class UI : public Nucleo::Thread {
+public:
+  virtual void run()
+  {
+    while (1) {
+      DELAY(UI_BUSY);
+      yield();
+    }
+  }
+};
+
+Radio radio;
+UI ui[UI_MAX];
+
+/**
+ * Probe thread; signal radio thread and yield.
+ */
+class Probe : public Nucleo::Thread {
+public:
+  virtual void run()
+  {
+    // Radio thread with same priority as user interface threads
+    reset();
+    MEASURE("signal-wakeup:same priority: ", SAMPLES) sample();
+    report(PSTR("same priority"));
+
+    // Radio thread with highest priority
+    radio.priority(PRIORITY_MAX - 1);
+    reset();
+    MEASURE("signal-wakeup:high priority: ", SAMPLES) sample();
+    report(PSTR("high priority"));
+
+    // Print thread stack usage and stop the benchmark run
+    Nucleo::Thread::print(trace);
+    ASSERT(true == false);
+  }
+
+  void reset()
+  {
+    latency_max = 0L;
+    latency_sum = 0L;
+  }
+
+  void sample()
+  {
+    stamp = RTT::micros();
+    irq.signal(1, false);
+    yield();
+  }
+
+  void report(str_P msg)
+  {
+    trace << msg
+	  << PSTR(":latency:max=") << latency_max
+	  << PSTR(" us,avg=") << latency_sum / SAMPLES
+	  << PSTR(" us")
+	  << endl;
+  }
+};
+
+Probe probe;
+
+void setup()
+{
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaBenchmarkNucleo: started"));
+  trace.flush();
+
+  // Print CPU clock and instructions per 1MHZ
+  TRACE(F_CPU);
+  TRACE(I_CPU);
+  TRACE(UI_MAX);
+  TRACE(UI_BUSY);
+
+  // Start timers
+  Watchdog::begin();
+  RTT::begin();
+
+  // Start threads; all on lowest priority
+  Nucleo::Thread::begin(&radio, 64);
+  for (uint8_t i = 0; i < UI_MAX; i++)
+    Nucleo::Thread::begin(&ui[i], 64);
+  Nucleo::Thread::begin(&probe, 128);
+  Nucleo::Thread::begin();
+}
+
+void loop()
+{
+  // Run the kernel
+  Nucleo::Thread::service();
+}
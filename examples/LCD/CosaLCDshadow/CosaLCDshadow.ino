@@ -0,0 +1,111 @@
+/**
+ * @file CosaLCDshadow.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Demonstration of the HD44780 shadow text buffer. The whole screen
+ * is redrawn every 100 ms but only the changed cells (the counters)
+ * are written to the display by the periodic shadow update.
+ *
+ * @section Circuit
+ * See HD44780.hh for description of LCD adapter circuits.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Cosa/Types.h"
+#include "Cosa/RTT.hh"
+#include "Cosa/Periodic.hh"
+#include "Cosa/Watchdog.hh"
+#include "Cosa/IOStream.hh"
+
+// Select port type to use with the LCD device driver.
+// LCD and communication port
+#include <HD44780.h>
+
+// HD44780 driver built-in adapters
+// HD44780::Port4b port;
+// HD44780::SR3W port;
+// HD44780::SR3WSPI port;
+// HD44780::SR4W port;
+
+// I2C expander io port based adapters
+// #include <PCF8574.h>
+// #include <MJKDZ_LCD_Module.h>
+// MJKDZ_LCD_Module port;
+// MJKDZ_LCD_Module port(0);
+// #include <GY_IICLCD.h>
+// GY_IICLCD port;
+// #include <DFRobot_IIC_LCD_Module.h>
+// DFRobot_IIC_LCD_Module port;
+// #include <SainSmart_LCD2004.h>
+// SainSmart_LCD2004 port;
+#include <MCP23008.h>
+#include <Adafruit_I2C_LCD_Backpack.h>
+Adafruit_I2C_LCD_Backpack port;
+
+// HD44780 based LCD with support for serial communication
+// #include <ERM1602_5.h>
+// ERM1602_5 port;
+
+// HD44780 variants; 16X1, 16X2, 16X4, 20X4, default 16X2
+// HD44780 lcd(&port, 20, 4);
+// HD44780 lcd(&port, 16, 4);
+HD44780 lcd(&port);
+
+// Shadow text buffer; write changes every 50 ms
+RTT::Scheduler scheduler;
+HD44780::Shadow shadow(&lcd, &scheduler, 50000UL);
+IOStream cout(&shadow);
+
+// Redraw the whole screen every 100 ms
+class Screen : public Periodic {
+public:
+  Screen(Job::Scheduler* scheduler) :
+    Periodic(scheduler, 100000UL),
+    m_count(0)
+  {}
+
+  virtual void run()
+  {
+    cout << clear;
+    cout << PSTR("count: ") << m_count++ << endl;
+    cout << PSTR("millis: ") << RTT::millis();
+  }
+
+private:
+  uint16_t m_count;
+};
+
+Screen screen(&scheduler);
+
+void setup()
+{
+  Watchdog::begin();
+  RTT::begin();
+
+#if defined(COSA_ADAFRUIT_I2C_LCD_BACKPACK_H)
+  twi.set_freq(TWI::MAX_FREQ);
+#endif
+
+  shadow.begin();
+  screen.reschedule();
+}
+
+void loop()
+{
+  Event::service();
+}
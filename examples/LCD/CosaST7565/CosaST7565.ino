@@ -172,8 +172,7 @@ void setup()
   offscreen.draw_string(PSTR("OffScreen Canvas"));
 
   // Draw the off-screen canvas on the LCD
-  lcd.set_cursor(0, 0);
-  lcd.draw_bitmap(offscreen.bitmap(), offscreen.WIDTH, offscreen.HEIGHT);
+  offscreen.flush(&lcd);
   sleep(4);
 }
 
@@ -225,7 +224,7 @@ void loop()
 
     // Draw the off-screen canvas on the LCD
     lcd.putchar('\f');
-    lcd.draw_bitmap(offscreen.bitmap(), offscreen.WIDTH, offscreen.HEIGHT);
+    offscreen.flush(&lcd);
     // Decrement counter
     if (sec == 0) {
       if (min != 00) {
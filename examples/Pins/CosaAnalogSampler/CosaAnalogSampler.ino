@@ -0,0 +1,85 @@
+/**
+ * @file CosaAnalogSampler.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Cosa demonstration of free running multi-channel analog sampler.
+ * Two channels are sampled with 4X oversampling (11-bit) and the
+ * block average per channel is printed.
+ *
+ * @section Circuit
+ * @code
+ *
+ * (A0)-----------------<
+ * (A1)-----------------<
+ *
+ * @endcode
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Cosa/AnalogSampler.hh"
+#include "Cosa/Event.hh"
+#include "Cosa/Watchdog.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/UART.hh"
+
+// Analog pin vector for sampler. Note: use program memory
+const Board::AnalogPin pins[] __PROGMEM = {
+  Board::A0,
+  Board::A1
+};
+
+// Block size (samples) and double buffer
+static const uint16_t BLOCK_MAX = 64;
+uint16_t buffer[2 * BLOCK_MAX];
+
+// Sampler with block handler; print average per channel
+class Sampler : public AnalogSampler {
+public:
+  Sampler() : AnalogSampler(pins, membersof(pins), buffer, BLOCK_MAX, 1) {}
+
+  virtual void on_block(const uint16_t* block, uint16_t size)
+  {
+    uint32_t sum[membersof(pins)];
+    for (uint8_t i = 0; i < membersof(pins); i++) sum[i] = 0;
+    for (uint16_t i = 0; i < size; i += membersof(pins))
+      for (uint8_t j = 0; j < membersof(pins); j++)
+	sum[j] += block[i + j];
+    uint16_t samples = size / membersof(pins);
+    trace << Watchdog::millis() << ':';
+    for (uint8_t i = 0; i < membersof(pins); i++)
+      trace << ' ' << sum[i] / samples;
+    trace << PSTR(", dropped=") << dropped() << endl;
+  }
+};
+
+Sampler sampler;
+
+void setup()
+{
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaAnalogSampler: started"));
+  Watchdog::begin();
+
+  // Conversion every 2 ms; 125 Hz per channel with oversampling
+  ASSERT(sampler.begin(2000));
+}
+
+void loop()
+{
+  Event::service();
+}
@@ -0,0 +1,132 @@
+/**
+ * @file CosaTWIPoller.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Cosa demonstration of queued TWI transactions and periodic bus
+ * polling. The accelerometer, gyroscope and compass of a 10-DOF
+ * module (ADXL345, L3G4200D and HMC5883L) are read as a single
+ * asynchronous burst every 100 ms. Each register read is a write
+ * segment (register address) chained with a read segment (repeated
+ * START).
+ *
+ * @section Circuit
+ * The Arduino analog pins 4 (SDA) and 5 (SCL) are used for I2C/TWI
+ * connection.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Cosa/TWI.hh"
+#include "Cosa/Watchdog.hh"
+#include "Cosa/RTT.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/UART.hh"
+
+// Device bus addresses
+TWI::Driver accelerometer(0x53);
+TWI::Driver gyroscope(0x69);
+TWI::Driver compass(0x1e);
+
+// Register read transaction; three axis sample
+class Sample : public TWI::Transaction {
+public:
+  Sample(TWI::Driver* dev, uint8_t reg, str_P name) :
+    TWI::Transaction(dev),
+    m_name(name)
+  {
+    write_read(reg, m_data, sizeof(m_data));
+  }
+
+  virtual void on_completion(int count)
+  {
+    trace << m_name << ':';
+    if (count != sizeof(m_data))
+      trace << PSTR("error=") << count;
+    else
+      trace << m_data[0] << ',' << m_data[1] << ',' << m_data[2];
+    trace << ' ';
+  }
+
+protected:
+  str_P m_name;
+  int16_t m_data[3];
+};
+
+// The last transaction in the burst prints the time stamp
+class Burst : public Sample {
+public:
+  Burst(TWI::Driver* dev, uint8_t reg, str_P name) :
+    Sample(dev, reg, name)
+  {}
+
+  virtual void on_completion(int count)
+  {
+    Sample::on_completion(count);
+    trace << RTT::millis() << endl;
+  }
+};
+
+// Register read; L3G4200D requires auto-increment of register address
+static const char ACC[] __PROGMEM = "acc";
+static const char GYRO[] __PROGMEM = "gyro";
+static const char MAG[] __PROGMEM = "mag";
+Sample acc(&accelerometer, 0x32, (str_P) ACC);
+Sample gyro(&gyroscope, 0x28 | 0x80, (str_P) GYRO);
+Burst mag(&compass, 0x03, (str_P) MAG);
+
+// Poll the devices every 100 ms
+TWI::Transaction* burst[] = { &acc, &gyro, &mag };
+RTT::Scheduler scheduler;
+TWI::Poller poller(&scheduler, 100000UL, burst, membersof(burst));
+
+// Configuration; measurement mode with write-only transactions
+uint8_t ADXL345_POWER_CTL[] = { 0x2d, 0x08 };
+uint8_t L3G4200D_CTRL_REG1[] = { 0x20, 0x0f };
+uint8_t HMC5883L_MODE[] = { 0x02, 0x00 };
+TWI::Transaction power(&accelerometer);
+TWI::Transaction rate(&gyroscope);
+TWI::Transaction mode(&compass);
+
+void setup()
+{
+  // Start trace output stream on the serial port
+  uart.begin(57600);
+  trace.begin(&uart, PSTR("CosaTWIPoller: started"));
+  TRACE(sizeof(TWI::Transaction));
+  TRACE(sizeof(TWI::Poller));
+
+  // Start the watchdog and real-time clock
+  Watchdog::begin();
+  RTT::begin();
+
+  // Configure the devices; queued back to back
+  power.write(ADXL345_POWER_CTL, sizeof(ADXL345_POWER_CTL));
+  rate.write(L3G4200D_CTRL_REG1, sizeof(L3G4200D_CTRL_REG1));
+  mode.write(HMC5883L_MODE, sizeof(HMC5883L_MODE));
+  twi.post(&power);
+  twi.post(&rate);
+  twi.post(&mode);
+  while (mode.is_busy()) yield();
+
+  // Start periodic polling
+  poller.begin();
+}
+
+void loop()
+{
+  Event::service();
+}
@@ -35,10 +35,11 @@
  * Default configuration (generated with TI SmartRF Studio tool):
  * Radio: 433 MHz, 38 kbps, GFSK. Whitening, 0 dBm.
  * Packet: Variable packet length with CRC, address check and broadcast(0x00)
- * FIFO: Append link status.
- * Frame: sync(2), length(1), dest(1), payload(max 59), crc(2)
- * - Send(62): length(1), dest(1), src(1), payload(max 59)
- * - Received(64): length(1), dest(1), src(1), payload(max 59), status(2)
+ * FIFO: Append link status. Threshold TX 33 bytes, RX 32 bytes.
+ * Frame: sync(2), length(1), dest(1), src(1), port(1), payload, crc(2)
+ * - Send: length(1), dest(1), src(1), port(1), payload(max 252)
+ * - Received: length(1), dest(1), src(1), port(1), payload, status(2)
+ * - Packet length register is set to max (255) by begin()
  * Digital Output Pins:
  * - GDO2: valid frame received, active low
  * - GDO1: high impedance when CSN is high otherwise serial data output
@@ -102,6 +103,7 @@ CC1101::CC1101(uint16_t net, uint8_t dev,
   SPI::Driver(csn, SPI::ACTIVE_LOW, SPI::DIV4_CLOCK, 0, SPI::MSB_ORDER, &m_irq),
   Wireless::Driver(net, dev),
   m_irq(irq, ExternalInterrupt::ON_FALLING_MODE, this),
+  m_gdo2(GDO_CRC_OK | GDO_INV),
   m_status(0)
 {
 }
@@ -123,6 +125,35 @@ CC1101::await(Mode mode)
   while (read_status().mode != mode) DELAY(100);
 }
 
+void
+CC1101::gdo2(uint8_t cfg)
+{
+  spi.acquire(this);
+    spi.begin();
+      loop_until_bit_is_clear(PIN, Board::MISO);
+      write(IOCFG2, cfg);
+    spi.end();
+  spi.release();
+}
+
+uint8_t
+CC1101::fifo_bytes(Status reg)
+{
+  uint8_t res;
+  uint8_t prev;
+  spi.acquire(this);
+    spi.begin();
+      loop_until_bit_is_clear(PIN, Board::MISO);
+      res = read(reg);
+      do {
+	prev = res;
+	res = read(reg);
+      } while (res != prev);
+    spi.end();
+  spi.release();
+  return (res);
+}
+
 bool
 CC1101::begin(const void* config)
 {
@@ -133,12 +164,12 @@ CC1101::begin(const void* config)
   DELAY(300);
 
   // Upload the configuration. Check for default configuration
+  const uint8_t* cp = config ? (const uint8_t*) config : CC1101::config;
+  m_gdo2 = pgm_read_byte(cp + IOCFG2);
   spi.acquire(this);
     spi.begin();
     loop_until_bit_is_clear(PIN, Board::MISO);
-    write_P(IOCFG2,
-	    config ? (const uint8_t*) config : CC1101::config,
-	    CONFIG_MAX);
+    write_P(IOCFG2, cp, CONFIG_MAX);
     spi.end();
 
     // Adjust configuration with instance specific state
@@ -149,6 +180,7 @@ CC1101::begin(const void* config)
       write(CHANNR, m_channel);
       write(ADDR, m_addr.device);
       write(SYNC1, &sync, sizeof(sync));
+      write(PKTLEN, FRAME_MAX);
     spi.end();
   spi.release();
 
@@ -178,6 +210,15 @@ CC1101::send(uint8_t dest, uint8_t port, const iovec_t* vec)
   if (UNLIKELY(len > PAYLOAD_MAX)) return (EMSGSIZE);
 
   // Write frame length and header(dest, src, port) and payload buffers
+  // that fit in the fifo. Use the threshold interrupt to stream
+  // larger frames
+  bool streaming = (len + 4 > DEVICE_PAYLOAD_MAX);
+  if (streaming) gdo2(GDO_TX_THRESHOLD);
+  size_t count = DEVICE_PAYLOAD_MAX - 4;
+  size_t left = len;
+  const uint8_t* bp = (const uint8_t*) vec->buf;
+  size_t size = vec->size;
+  int res;
   spi.acquire(this);
     spi.begin();
       loop_until_bit_is_clear(PIN, Board::MISO);
@@ -186,15 +227,89 @@ CC1101::send(uint8_t dest, uint8_t port, const iovec_t* vec)
       spi.transfer(dest);
       spi.transfer(m_addr.device);
       spi.transfer(port);
-      spi.write(vec);
+      if (!streaming) spi.write(vec);
     spi.end();
   spi.release();
 
-  // Trigger transmission and wait for completion
-  strobe(STX);
-  await(IDLE_MODE);
+  // Trigger transmission. Refill the fifo when below threshold
+  m_avail = false;
+  if (!streaming) {
+    strobe(STX);
+  }
+  else {
+    while (1) {
+      if (count > left) count = left;
+      left -= count;
+      spi.acquire(this);
+	spi.begin();
+	  loop_until_bit_is_clear(PIN, Board::MISO);
+	  m_status = spi.transfer(header_t(TXFIFO, 1, 0));
+	  while (count != 0) {
+	    while (size == 0) {
+	      vec += 1;
+	      bp = (const uint8_t*) vec->buf;
+	      size = vec->size;
+	    }
+	    size_t n = (size > count ? count : size);
+	    spi.write(bp, n);
+	    bp += n;
+	    size -= n;
+	    count -= n;
+	  }
+	spi.end();
+      spi.release();
+      if (m_status.mode != TX_MODE) strobe(STX);
+      if (left == 0) break;
+      uint32_t start = RTT::millis();
+      while (!m_avail && (RTT::since(start) < TX_TIMEOUT)) yield();
+      if (UNLIKELY(!m_avail)) {
+	res = ETIME;
+	goto error;
+      }
+      m_avail = false;
+
+      // Check that the fifo did not underflow while waiting
+      uint8_t bytes = fifo_bytes(TXBYTES);
+      if (UNLIKELY(bytes & FIFO_MASK)) {
+	res = EIO;
+	goto error;
+      }
+      count = DEVICE_PAYLOAD_MAX - (bytes & BYTES_MASK);
+    }
+  }
 
+  // Wait for completion; check for fifo underflow (late refill)
+  {
+    uint32_t start = RTT::millis();
+    while (1) {
+      Mode mode = (Mode) read_status().mode;
+      if (mode == IDLE_MODE) break;
+      if (UNLIKELY(mode == TXFIFO_UNDERFLOW_MODE)) {
+	res = EIO;
+	goto error;
+      }
+      if (UNLIKELY(RTT::since(start) >= TX_TIMEOUT)) {
+	res = ETIME;
+	goto error;
+      }
+      DELAY(100);
+    }
+  }
+
+  // Restore interrupt pin configuration
+  if (streaming) {
+    gdo2(m_gdo2);
+    m_avail = false;
+  }
   return (len);
+
+ error:
+  // Abort transmission and flush the fifo
+  strobe(SIDLE);
+  strobe(SFTX);
+  if (streaming) gdo2(m_gdo2);
+  m_avail = false;
+  return (res);
 }
 
 int
@@ -211,54 +326,110 @@ int
 CC1101::recv(uint8_t& src, uint8_t& port, void* buf, size_t len, uint32_t ms)
 {
   uint32_t start = RTT::millis();
+  uint8_t header[3];
   uint8_t size;
+  int res;
 
-  // Put in receive mode and wait for incoming message
-  strobe(SFRX);
-  strobe(SRX);
-  m_avail = false;
-  do {
+  // Interrupt on sync word and drain the fifo while receiving
+  gdo2(GDO_SYNC_WORD | GDO_INV);
+  while (1) {
+    // Put in idle mode (aborts any frame in progress), flush the fifo
+    // and put in receive mode. Wait for incoming frame
+    strobe(SIDLE);
+    while (1) {
+      Mode mode = (Mode) read_status().mode;
+      if ((mode == IDLE_MODE) || (mode == RXFIFO_OVERFLOW_MODE)) break;
+      DELAY(10);
+    }
+    strobe(SFRX);
+    strobe(SRX);
+    m_avail = false;
     while (!m_avail && ((ms == 0) || (RTT::since(start) < ms))) yield();
     if (!m_avail) {
-      strobe(SIDLE);
-      return (ETIME);
+      res = ETIME;
+      break;
+    }
+
+    // Read the frame length; check for aborted frame. Do not empty
+    // the fifo while receiving (Errata SWRZ020)
+    uint8_t avail;
+    while (((avail = fifo_bytes(RXBYTES)) & BYTES_MASK) < 2) {
+      if (avail & FIFO_MASK) break;
+      if (read_status().mode != RX_MODE) break;
+      yield();
     }
-    // Check the received frame size
+    if (avail & FIFO_MASK) continue;
+    if (avail == 0) continue;
     spi.acquire(this);
       spi.begin();
-        loop_until_bit_is_clear(PIN, Board::MISO);
-	size = read(RXBYTES);
+	loop_until_bit_is_clear(PIN, Board::MISO);
+	size = read(RXFIFO);
       spi.end();
     spi.release();
-  } while ((size & BYTES_MASK) == 0);
-
-  // Put in idle mode and read the payload
-  strobe(SIDLE);
+    if (size < sizeof(header)) continue;
+    size -= sizeof(header);
+    if (size > len) {
+      res = EMSGSIZE;
+      break;
+    }
 
-  // Read the payload size and check against buffer length
-  spi.acquire(this);
-    spi.begin();
-      loop_until_bit_is_clear(PIN, Board::MISO);
-      m_status = spi.transfer(header_t(RXFIFO, 1, 1));
-      size = spi.transfer(0) - 3;
-      if (size > len) {
-	spi.end();
-	spi.release();
-	strobe(SFRX);
-	return (EMSGSIZE);
+    // Drain the fifo; header, payload and status. Do not empty the
+    // fifo before the end of the frame (Errata SWRZ020)
+    uint16_t total = sizeof(header) + size + sizeof(m_recv_status);
+    uint16_t pos = 0;
+    while (pos < total) {
+      avail = fifo_bytes(RXBYTES);
+      if (avail & FIFO_MASK) break;
+      uint8_t count = avail & BYTES_MASK;
+      if ((count < total - pos) && (count > 0)) count -= 1;
+      if (count == 0) {
+	if (read_status().mode == IDLE_MODE) break;
+	yield();
+	continue;
       }
+      spi.acquire(this);
+	spi.begin();
+	  loop_until_bit_is_clear(PIN, Board::MISO);
+	  while (count != 0) {
+	    uint8_t* dp;
+	    uint16_t n;
+	    if (pos < sizeof(header)) {
+	      dp = header + pos;
+	      n = sizeof(header) - pos;
+	    }
+	    else if (pos < sizeof(header) + size) {
+	      dp = (uint8_t*) buf + pos - sizeof(header);
+	      n = sizeof(header) + size - pos;
+	    }
+	    else {
+	      dp = m_recv_status.status + pos - sizeof(header) - size;
+	      n = total - pos;
+	    }
+	    if (n > count) n = count;
+	    read(RXFIFO, dp, n);
+	    pos += n;
+	    count -= n;
+	  }
+	spi.end();
+      spi.release();
+    }
 
-      // Read the frame header(dest, src, port), payload and link quality status
-      m_dest = spi.transfer(0);
-      src = spi.transfer(0);
-      port = spi.transfer(0);
-      spi.read(buf, size);
-      spi.read(&m_recv_status, sizeof(m_recv_status));
-    spi.end();
-  spi.release();
+    // Check that the frame was completed with valid checksum
+    if ((pos == total) && m_recv_status.crc) {
+      m_dest = header[0];
+      src = header[1];
+      port = header[2];
+      res = size;
+      break;
+    }
+  }
 
-  // Fix: Add address checking for robustness
-  return (size);
+  // Put in idle mode and restore interrupt pin configuration
+  strobe(SIDLE);
+  strobe(SFRX);
+  gdo2(m_gdo2);
+  m_avail = false;
+  return (res);
 }
 
 void
@@ -64,12 +64,25 @@ public:
   static const size_t DEVICE_PAYLOAD_MAX = 64;
 
   /**
-   * Maximum size of payload. The device allows 64 bytes payload.
-   * The length and destination addressing will require two bytes,
-   * source address one byte, and port one byte. This gives a payload
-   * max of 64 - 4 = 60.
+   * Maximum size of frame in variable packet length mode; the length
+   * byte is not included.
    */
-  static const size_t PAYLOAD_MAX = DEVICE_PAYLOAD_MAX - 4;
+  static const size_t FRAME_MAX = 255;
+
+  /**
+   * Maximum size of payload. The frame includes destination and
+   * source address, and port. This gives a payload max of 255 - 3 =
+   * 252. Frames that do not fit the device fifo (64 bytes) are
+   * streamed; the transmit fifo is refilled on the fifo threshold
+   * interrupt and the receive fifo is drained while receiving.
+   */
+  static const size_t PAYLOAD_MAX = FRAME_MAX - 3;
+
+  /**
+   * Maximum time (milli-seconds) to wait for the transmit fifo
+   * threshold when streaming a frame.
+   */
+  static const uint16_t TX_TIMEOUT = 500;
 
   /**
    * Construct C1101 device driver with given network and device
@@ -119,7 +132,9 @@ public:
    * Send message in given null terminated io vector. Returns number
    * of bytes sent. Returns error code(-1) if number of bytes is
    * greater than PAYLOAD_MAX. Return error code(-2) if fails to set
-   * transmit mode.
+   * transmit mode. Returns ETIME if a streamed frame is not sent
+   * within TX_TIMEOUT per fifo refill, and EIO if the transmit fifo
+   * underflows.
    * @param[in] dest destination network address.
    * @param[in] port device port (or message type).
    * @param[in] vec null termianted io vector.
@@ -592,6 +607,33 @@ protected:
    */
   void await(Mode mode);
 
+  /**
+   * GDO2 pin configuration (Table 41, pp. 62). The pin is connected
+   * to the interrupt pin which triggers on falling edge.
+   */
+  enum {
+    GDO_RX_THRESHOLD = 0x00,	//!< RX FIFO at or above threshold.
+    GDO_TX_THRESHOLD = 0x02,	//!< TX FIFO at or above threshold.
+    GDO_SYNC_WORD = 0x06,	//!< Sync word sent/received until end.
+    GDO_CRC_OK = 0x07,		//!< Packet received with CRC OK.
+    GDO_INV = 0x40		//!< Invert output; active low.
+  } __attribute__((packed));
+
+  /**
+   * Set GDO2 pin configuration.
+   * @param[in] cfg pin configuration.
+   */
+  void gdo2(uint8_t cfg);
+
+  /**
+   * Read number of bytes in given fifo status register (TXBYTES or
+   * RXBYTES). The register is read until two consecutive readings
+   * are the same (Errata SWRZ020).
+   * @param[in] reg fifo status register.
+   * @return number of bytes and overflow/underflow flag.
+   */
+  uint8_t fifo_bytes(Status reg);
+
   /**
    * Main Radio Control State Machine State (pp. 93).
    */
@@ -677,6 +719,7 @@ private:
   static const uint8_t config[] __PROGMEM;
 
   IRQPin m_irq;			//!< Interrupt pin and handler.
+  uint8_t m_gdo2;		//!< Configured GDO2 pin setting.
   status_t m_status;		//!< Status from latest transaction.
   recv_status_t m_recv_status;	//!< Status frm latest message receive.
 };
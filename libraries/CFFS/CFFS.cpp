@@ -22,6 +22,13 @@
 
 Flash::Device* CFFS::device = NULL;
 uint32_t CFFS::current_dir_addr = 0L;
+BitSet<CFFS::SECTOR_MAP_MAX> CFFS::allocated;
+BitSet<CFFS::SECTOR_MAP_MAX> CFFS::collect;
+uint16_t CFFS::free_sectors = 0;
+uint16_t CFFS::garbage_sectors = 0;
+uint16_t CFFS::next_sector = 0;
+CFFS::tail_t CFFS::tail[TAIL_MAX];
+uint8_t CFFS::next_tail = 0;
 
 int
 CFFS::File::open(const char* filename, uint8_t oflag)
@@ -37,6 +44,7 @@ CFFS::File::open(const char* filename, uint8_t oflag)
     m_current_addr = m_entry.ref + sizeof(CFFS::descr_t);
     m_current_pos = 0L;
     m_file_size = 0L;
+    update_end_of_file(m_entry.ref, m_current_addr, m_file_size);
   }
 
   // Check that the file exists; open file
@@ -153,6 +161,7 @@ CFFS::File::read(void* buf, size_t size)
   while (size != 0) {
     int res = CFFS::read(buf, m_current_addr, size);
     if (res < 0) return (EIO);
+    buf = (uint8_t*) buf + res;
     size -= res;
     m_current_pos += res;
     m_current_addr += res;
@@ -192,6 +201,7 @@ CFFS::File::write(const void* buf, size_t size, bool progmem)
     else
       res = CFFS::write(m_current_addr, buf, size);
     if (res < 0) return (res);
+    buf = (const uint8_t*) buf + res;
     m_current_addr += res;
     m_current_pos += res;
     m_file_size += res;
@@ -220,6 +230,9 @@ CFFS::File::write(const void* buf, size_t size, bool progmem)
       // Continue write in new sector
       m_current_addr = sector + sizeof(header);
     }
+
+    // Update the end of file table
+    update_end_of_file(m_entry.ref, m_current_addr, m_file_size);
   }
   return (count);
 }
@@ -243,9 +256,44 @@ CFFS::begin(Flash::Device* flash)
       || strcmp_P(entry.name, PSTR("..")))
     return (false);
 
+  // Check that the sector state maps can hold the device
+  if (flash->SECTOR_MAX > SECTOR_MAP_MAX) return (false);
+  uint32_t root = addr;
+
+  // Build the sector state maps; allocated, garbage or free sectors.
+  // Continue allocation after the last allocated sector
+  allocated.empty();
+  collect.empty();
+  free_sectors = 0;
+  garbage_sectors = 0;
+  next_sector = 1;
+  allocated += 0;
+  addr = flash->SECTOR_BYTES;
+  for (uint16_t i = 1; i < flash->SECTOR_MAX; i++) {
+    uint16_t type;
+    if (flash->read(&type, addr, sizeof(type)) != sizeof(type))
+      return (false);
+    if (type == FREE_TYPE) {
+      free_sectors += 1;
+    }
+    else if ((type & ALLOC_MASK) == 0) {
+      collect += i;
+      garbage_sectors += 1;
+    }
+    else {
+      allocated += i;
+      next_sector = i + 1;
+    }
+    addr += flash->SECTOR_BYTES;
+  }
+
+  // Clear the end of file table
+  memset(tail, 0, sizeof(tail));
+  next_tail = 0;
+
   // A file system and root directory exists
   device = flash;
-  current_dir_addr = addr;
+  current_dir_addr = root;
   return (true);
 }
 
@@ -453,7 +501,7 @@ CFFS::remove(uint32_t addr, uint16_t type)
   if ((entry.type != type))
     return (EINVAL);
 
-  // Save reference to sector to erase
+  // Save reference to sectors to collect
   uint32_t ref = entry.ref;
 
   // Mark the entry as removed in the directory block
@@ -461,11 +509,21 @@ CFFS::remove(uint32_t addr, uint16_t type)
   if (device->write(addr, &entry, sizeof(entry)) != sizeof(entry))
     return (EIO);
 
-  // Erase sectors
+  // Remove from the end of file table
+  for (uint8_t i = 0; i < TAIL_MAX; i++)
+    if (tail[i].sector == ref) tail[i].sector = 0L;
+
+  // Mark sectors as garbage; erased by the garbage collector
+  const uint16_t mark = GARBAGE_TYPE;
   while (ref != NULL_REF) {
     if (device->read(&entry, ref, sizeof(entry)) != sizeof(entry))
       return (EIO);
-    if (device->erase(ref, entry.size / 1024) != 0) return (EIO);
+    if (device->write(ref, &mark, sizeof(mark)) != sizeof(mark))
+      return (EIO);
+    uint16_t ix = ref / device->SECTOR_BYTES;
+    allocated -= ix;
+    collect += ix;
+    garbage_sectors += 1;
     ref = entry.ref;
   }
   return (0);
@@ -499,34 +557,50 @@ CFFS::write_P(uint32_t dest, const void* src, size_t size)
 }
 
 uint32_t
-CFFS::next_free_sector()
+CFFS::allocate_sector()
 {
   // Check that the file system driver is initiated
   if (device == NULL) return (0L);
 
-  // Search for a free sector
-  descr_t header;
-  uint32_t addr = device->SECTOR_BYTES;
-  for (uint16_t i = 1; i < device->SECTOR_MAX; i++) {
-    if (device->read(&header, addr, sizeof(header)) != sizeof(header))
-      return (0L);
-    if (header.type != FREE_TYPE) {
-      addr += device->SECTOR_BYTES;
-      continue;
-    }
-    // Initiate the sector header
-    header.type = FILE_BLOCK_TYPE;
-    header.size = device->SECTOR_BYTES;
-    header.ref = NULL_REF;
-    memset(header.name, 0, sizeof(header.name));
-    if (device->write(addr, &header, sizeof(header)) != sizeof(header))
-      return (0L);
-    // Return address of sector
-    return (addr);
+  // Erase a garbage sector if there are no free sectors
+  if (free_sectors == 0) {
+    if (garbage_sectors == 0) return (0L);
+    if (gc(1) <= 0) return (0L);
+  }
+
+  // Search for a free sector from the latest allocated sector
+  uint16_t ix = next_sector;
+  for (uint16_t i = 0; i < device->SECTOR_MAX; i++, ix++) {
+    if (ix >= device->SECTOR_MAX) ix = 1;
+    if (allocated[ix] || collect[ix]) continue;
+    allocated += ix;
+    free_sectors -= 1;
+    next_sector = ix + 1;
+    return (ix * device->SECTOR_BYTES);
   }
   return (0L);
 }
 
+uint32_t
+CFFS::next_free_sector()
+{
+  // Allocate a free sector
+  uint32_t addr = allocate_sector();
+  if (addr == 0L) return (0L);
+
+  // Initiate the sector header
+  descr_t header;
+  header.type = FILE_BLOCK_TYPE;
+  header.size = device->SECTOR_BYTES;
+  header.ref = NULL_REF;
+  memset(header.name, 0, sizeof(header.name));
+  if (device->write(addr, &header, sizeof(header)) != sizeof(header))
+    return (0L);
+
+  // Return address of sector
+  return (addr);
+}
+
 uint32_t
 CFFS::next_free_directory()
 {
@@ -537,12 +611,8 @@ CFFS::next_free_directory()
   descr_t header;
   uint32_t addr;
   if (device->SECTOR_BYTES == device->DEFAULT_SECTOR_BYTES) {
-    addr = device->SECTOR_BYTES;
-    for (uint16_t i = 1; i < device->SECTOR_MAX; i++, addr += device->SECTOR_BYTES) {
-      if (device->read(&header, addr, sizeof(header)) != sizeof(header))
-	return (0L);
-      if (header.type == FREE_TYPE) break;
-    }
+    addr = allocate_sector();
+    if (addr == 0L) return (0L);
   }
   else {
     addr = device->DEFAULT_SECTOR_BYTES;
@@ -551,8 +621,8 @@ CFFS::next_free_directory()
 	return (0L);
       if (header.type == FREE_TYPE) break;
     }
+    if (header.type != FREE_TYPE) return (0L);
   }
-  if (header.type != FREE_TYPE) return (0L);
 
   // Initiate the parent directory reference
   memset(&header, 0, sizeof(header));
@@ -566,12 +636,61 @@ CFFS::next_free_directory()
   return (addr);
 }
 
+int
+CFFS::gc(uint8_t count)
+{
+  // Check that the file system driver is initiated
+  if (device == NULL) return (ENXIO);
+
+  // Erase given max number of garbage sectors
+  const uint8_t SIZE = device->SECTOR_BYTES / 1024;
+  int res = 0;
+  for (uint16_t ix = 1; count != 0 && ix < device->SECTOR_MAX; ix++) {
+    if (!collect[ix]) continue;
+    if (device->erase(ix * device->SECTOR_BYTES, SIZE) != 0) return (EIO);
+    collect -= ix;
+    garbage_sectors -= 1;
+    free_sectors += 1;
+    count -= 1;
+    res += 1;
+  }
+  return (res);
+}
+
+void
+CFFS::update_end_of_file(uint32_t sector, uint32_t pos, uint32_t size)
+{
+  // Update entry for file or replace the next entry
+  tail_t* entry = NULL;
+  for (uint8_t i = 0; i < TAIL_MAX; i++) {
+    if (tail[i].sector != sector) continue;
+    entry = &tail[i];
+    break;
+  }
+  if (entry == NULL) {
+    entry = &tail[next_tail];
+    next_tail = (next_tail + 1) & (TAIL_MAX - 1);
+    entry->sector = sector;
+  }
+  entry->addr = pos;
+  entry->size = size;
+}
+
 int
 CFFS::find_end_of_file(uint32_t addr, uint32_t &pos, uint32_t &size)
 {
   // Check that the file system driver is initiated
   if (device == NULL) return (ENXIO);
 
+  // Check the end of file table
+  for (uint8_t i = 0; i < TAIL_MAX; i++) {
+    if (tail[i].sector != addr) continue;
+    pos = tail[i].addr;
+    size = tail[i].size;
+    return (0);
+  }
+  uint32_t sector = addr;
+
   // Locate last sector
   descr_t header;
   size = 0L;
@@ -603,5 +722,6 @@ CFFS::find_end_of_file(uint32_t addr, uint32_t &pos, uint32_t &size)
   // And return position and size
   pos = addr;
   size += (addr & device->SECTOR_MASK) - sizeof(header);
+  update_end_of_file(sector, pos, size);
   return (0);
 }
@@ -24,13 +24,25 @@
 #include "Cosa/FS.hh"
 #include "Cosa/Flash.hh"
 #include "Cosa/IOStream.hh"
+#include "Cosa/BitSet.hh"
+#include "Cosa/Periodic.hh"
 
 /**
  * Cosa Flash File System for Flash Memory.
  *
+ * Sectors are allocated in a log-structured fashion; round-robin
+ * from the latest allocated sector so that erase cycles are spread
+ * over the flash device. The state of the sectors (allocated or
+ * garbage) is kept in memory and built when the file system is
+ * mounted. Sectors of removed files are marked as garbage on the
+ * flash and erased later by the garbage collector, gc(), which may
+ * be run in the background with a CFFS::Cleaner job. The end of
+ * recently accessed files is kept in a table so that open for
+ * append does not need to search the file.
+ *
  * @section Limitations
  * Directory entries are not reclaimed (directory block is not erased
- * and rewritten when full).
+ * and rewritten when full). Max 256 sectors.
  */
 class CFFS {
 public:
@@ -78,6 +90,7 @@ protected:
     DIR_ENTRY_TYPE = 0x8003,	//!< Directory reference entry.
     DIR_BLOCK_TYPE = 0x8004,	//!< Directory block.
     FREE_TYPE = 0xffff,		//!< Free descriptor.
+    GARBAGE_TYPE = 0x0000,	//!< Removed sector to be erased.
     ALLOC_MASK = 0x8000,	//!< Allocated mask.
     TYPE_MASK = 0x7fff		//!< Type mask.
   };
@@ -310,9 +323,105 @@ public:
    */
   static int format(Flash::Device* flash, const char* name);
 
+  /**
+   * Erase given max number of garbage sectors (sectors of removed
+   * files). Return number of erased sectors or negative error code
+   * (ENXIO, EIO).
+   * @param[in] count max number of sectors to erase (default 1).
+   * @return number of sectors or negative error code.
+   */
+  static int gc(uint8_t count = 1);
+
+  /**
+   * Return number of free (erased) sectors.
+   * @return number of sectors.
+   */
+  static uint16_t available()
+  {
+    return (free_sectors);
+  }
+
+  /**
+   * Return number of garbage sectors; sectors to be erased by the
+   * garbage collector.
+   * @return number of sectors.
+   */
+  static uint16_t garbage()
+  {
+    return (garbage_sectors);
+  }
+
+  /**
+   * Background garbage collector. Erase a garbage sector per period.
+   *
+   * @section Usage
+   * @code
+   * Watchdog::Scheduler scheduler;
+   * CFFS::Cleaner cleaner(&scheduler, 1024);
+   * ...
+   * cleaner.start();
+   * @endcode
+   */
+  class Cleaner : public Periodic {
+  public:
+    /**
+     * Construct garbage collector job with given scheduler and
+     * period.
+     * @param[in] scheduler for the job.
+     * @param[in] period between erase of garbage sectors.
+     */
+    Cleaner(Job::Scheduler* scheduler, uint32_t period) :
+      Periodic(scheduler, period)
+    {}
+
+    /**
+     * @override{Job}
+     * Erase a garbage sector if the flash device is ready.
+     */
+    virtual void run()
+    {
+      if (garbage_sectors == 0 || !device->is_ready()) return;
+      gc(1);
+    }
+  };
+
   friend class File;
 
 protected:
+  /** Max number of sectors in sector state maps. */
+  static const uint16_t SECTOR_MAP_MAX = 256;
+
+  /** Number of entries in end of file table. */
+  static const uint8_t TAIL_MAX = 4;
+
+  /** End of file table entry. */
+  struct tail_t {
+    uint32_t sector;		//!< First sector of file.
+    uint32_t addr;		//!< End of file address.
+    uint32_t size;		//!< File size.
+  };
+
+  /** Allocated sectors. */
+  static BitSet<SECTOR_MAP_MAX> allocated;
+
+  /** Garbage sectors; to be erased. */
+  static BitSet<SECTOR_MAP_MAX> collect;
+
+  /** Number of free sectors. */
+  static uint16_t free_sectors;
+
+  /** Number of garbage sectors. */
+  static uint16_t garbage_sectors;
+
+  /** Next sector to check for allocation. */
+  static uint16_t next_sector;
+
+  /** End of file table. */
+  static tail_t tail[TAIL_MAX];
+
+  /** Next end of file table entry to replace. */
+  static uint8_t next_tail;
+
   /** Number of directory sectors. */
   static const size_t DIR_MAX = 16;
 
@@ -411,6 +520,22 @@ protected:
    * @return zero or negative error code.
    */
   static int find_end_of_file(uint32_t sector, uint32_t &pos, uint32_t &size);
+
+  /**
+   * Update the end of file table with the given file first sector,
+   * end of file address and size.
+   * @param[in] sector address of first sector of file.
+   * @param[in] pos address of end of file.
+   * @param[in] size of file.
+   */
+  static void update_end_of_file(uint32_t sector, uint32_t pos, uint32_t size);
+
+  /**
+   * Allocate a free sector and mark as allocated. Returns sector
+   * address or zero.
+   * @return sector address or zero.
+   */
+  static uint32_t allocate_sector();
 };
 
 #endif
@@ -123,18 +123,40 @@ Canvas::draw_image(uint16_t x, uint16_t y, Image* image)
   color16_t saved = set_pen_color(0);
   uint16_t width = image->WIDTH;
   uint16_t height = image->HEIGHT;
-  for (uint16_t i = 0; i < height; i++) {
-    color16_t buf[Image::BUFFER_MAX];
-    size_t count;
-    for (uint16_t j = 0; j < width; j += count) {
-      count = (width - j > Image::BUFFER_MAX) ? Image::BUFFER_MAX : width - j;
-      image->read(buf, Image::BUFFER_MAX);
-      for (uint8_t k = 0; k < count; k++) {
-	set_pen_color(buf[k]);
-	draw_pixel(x + j, y + i);
+
+  // Compressed images are read and drawn as color runs
+  if (image->is_compressed()) {
+    for (uint16_t i = 0; i < height; i++) {
+      size_t count;
+      for (uint16_t j = 0; j < width; j += count) {
+	color16_t color;
+	count = image->read_run(color, width - j);
+	if (UNLIKELY(count == 0)) goto error;
+	set_pen_color(color);
+	if (count == 1)
+	  draw_pixel(x + j, y + i);
+	else
+	  draw_horizontal_line(x + j, y + i, count);
+      }
+    }
+  }
+
+  // Uncompressed images are read in buffers
+  else {
+    for (uint16_t i = 0; i < height; i++) {
+      color16_t buf[Image::BUFFER_MAX];
+      size_t count;
+      for (uint16_t j = 0; j < width; j += count) {
+	count = (width - j > Image::BUFFER_MAX) ? Image::BUFFER_MAX : width - j;
+	if (UNLIKELY(!image->read(buf, count))) goto error;
+	for (uint8_t k = 0; k < count; k++) {
+	  set_pen_color(buf[k]);
+	  draw_pixel(x + j + k, y + i);
+	}
       }
     }
   }
+ error:
   set_pen_color(saved);
 }
 
@@ -378,10 +400,17 @@ void
 Canvas::draw_char(uint16_t x, uint16_t y, char c)
 {
   uint8_t scale = get_text_scale();
-  color16_t saved = set_pen_color(get_text_color());
   Font* font = get_text_font();
+  uint16_t width = scale * (font->WIDTH + font->SPACING);
+  color16_t saved;
+  if (get_text_opaque()) {
+    saved = set_pen_color(get_canvas_color());
+    fill_rect(x, y, width, scale * font->HEIGHT);
+    set_pen_color(get_text_color());
+  }
+  else saved = set_pen_color(get_text_color());
   font->draw(this, c, x, y, scale);
-  set_cursor(x + scale * (font->WIDTH + font->SPACING), y);
+  set_cursor(x + width, y);
   set_pen_color(saved);
 }
 
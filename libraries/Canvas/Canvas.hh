@@ -143,7 +143,7 @@ public:
     /**
      * Construct a drawing context with default pen color(BLACK),
      * canvas color(WHITE), text color(BLACK), text scale(1),
-     * and cursor at (0, 0).
+     * transparent text and cursor at (0, 0).
      * @param[in] font default is the system font.
      * @pre font != 0
      */
@@ -152,6 +152,7 @@ public:
       m_canvas_color(WHITE),
       m_text_color(BLACK),
       m_text_scale(1),
+      m_text_opaque(false),
       m_font(font)
     {
       set_cursor(0, 0);
@@ -263,6 +264,30 @@ public:
       return (previous);
     }
 
+    /**
+     * Get context text mode. Return true(1) if characters are drawn
+     * with canvas color background (opaque) otherwise false(0).
+     * @return bool.
+     */
+    bool get_text_opaque() const
+    {
+      return (m_text_opaque);
+    }
+
+    /**
+     * Set context text mode. Opaque characters are drawn as a cell,
+     * including character spacing, with canvas color background.
+     * Return previous mode.
+     * @param[in] opaque text mode.
+     * @return previous mode.
+     */
+    bool set_text_opaque(bool opaque)
+    {
+      bool previous = m_text_opaque;
+      m_text_opaque = opaque;
+      return (previous);
+    }
+
     /**
      * Get context cursor position.
      * @param[out] x.
@@ -301,6 +326,7 @@ public:
     color16_t m_canvas_color;	//!< Current background color.
     color16_t m_text_color;	//!< Current text color.
     uint8_t m_text_scale;	//!< Current text scale.
+    bool m_text_opaque;		//!< Current text mode.
     Font* m_font;		//!< Current font.
     pos16_t m_cursor;		//!< Current cursor position.
   };
@@ -359,6 +385,35 @@ public:
      */
     virtual bool read(color16_t* buf, size_t count) = 0;
 
+    /**
+     * @override{Canvas::Image}
+     * Read next run of pixels with the same color, at most given
+     * number of pixels. Return number of pixels or zero(0) on
+     * error. Default implementation reads a single pixel. Should be
+     * overridden by compressed images.
+     * @param[out] color of run.
+     * @param[in] max number of pixels.
+     * @return number of pixels.
+     */
+    virtual size_t read_run(color16_t& color, size_t max)
+    {
+      if (UNLIKELY(max == 0)) return (0);
+      return (read(&color, 1) ? 1 : 0);
+    }
+
+    /**
+     * @override{Canvas::Image}
+     * Return true(1) if the image should be drawn with read_run()
+     * otherwise false(0); pixels are then read in buffers with
+     * read(). Default false. Should be overridden by compressed
+     * images.
+     * @return bool.
+     */
+    virtual bool is_compressed() const
+    {
+      return (false);
+    }
+
     /** Buffer size. */
     static const size_t BUFFER_MAX = 32;
   };
@@ -509,6 +564,26 @@ public:
     return (m_context->set_text_scale(scale));
   }
 
+  /**
+   * Get current text mode; true(1) if opaque otherwise false(0).
+   * @return bool.
+   */
+  bool get_text_opaque() const
+  {
+    return (m_context->get_text_opaque());
+  }
+
+  /**
+   * Set current text mode; opaque (canvas color background) or
+   * transparent. Return previous mode.
+   * @param[in] opaque text mode.
+   * @return previous mode.
+   */
+  bool set_text_opaque(bool opaque)
+  {
+    return (m_context->set_text_opaque(opaque));
+  }
+
   /**
    * Get current cursor position.
    * @param[out] x.
@@ -919,7 +994,7 @@ public:
 
   /**
    * @override{Canvas}
-   * Draw character with current text color, font and scale.
+   * Draw character with current text color, font, scale and mode.
    * @param[in] x position.
    * @param[in] y position.
    * @param[in] c character.
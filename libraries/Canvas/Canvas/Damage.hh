@@ -0,0 +1,343 @@
+/**
+ * @file Canvas/Damage.hh
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#ifndef COSA_CANVAS_DAMAGE_HH
+#define COSA_CANVAS_DAMAGE_HH
+
+#include "Cosa/Types.h"
+#include <Canvas.h>
+
+/**
+ * Damage tracking canvas; partial refresh layer for a canvas
+ * device. Drawing outside flush() is not forwarded to the device;
+ * the bounding rectangle of each drawing operation is recorded as
+ * damage (dirty rectangle). Dirty rectangles are clipped to the
+ * canvas and merged when the union does not add pixels. When the
+ * damage list is full the rectangle is merged with the entry that
+ * grows the least.
+ *
+ * The sub-class repaint() member function should draw the scene.
+ * It is called by flush() once per dirty rectangle with the rectangle
+ * as clip. Only primitives within the clip are forwarded to the
+ * device, clipped, as windowed writes (fill_rect, lines and
+ * characters). Images are streams and must be restarted by repaint().
+ * The number of pixels drawn by repaint() and pushed to the device
+ * are counted.
+ *
+ * @section Usage
+ * @code
+ * class Panel : public Damage {
+ * public:
+ *   Panel(Canvas* canvas) : Damage(canvas) {}
+ *   virtual void repaint() { ... draw the panel ... }
+ * };
+ * Panel panel(&tft);
+ * ...
+ * panel.fill_rect(x, y, width, height);  // Record damage
+ * panel.flush();                         // Repaint damage
+ * @endcode
+ */
+class Damage : public Canvas {
+public:
+  /** Max number of dirty rectangles. */
+  static const uint8_t DAMAGE_MAX = 8;
+
+  /**
+   * Construct damage tracking layer for the given canvas device. The
+   * canvas device is drawn with the layer context during flush().
+   * @param[in] canvas device.
+   */
+  Damage(Canvas* canvas) :
+    Canvas(canvas->WIDTH, canvas->HEIGHT),
+    m_canvas(canvas),
+    m_count(0),
+    m_flushing(false),
+    m_drawn(0),
+    m_pushed(0)
+  {
+    m_direction = canvas->get_orientation();
+  }
+
+  /**
+   * Record given rectangle as damage.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] width.
+   * @param[in] height.
+   */
+  void mark(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+  /**
+   * Record the whole canvas as damage.
+   */
+  void mark()
+  {
+    mark(0, 0, WIDTH, HEIGHT);
+  }
+
+  /**
+   * Return number of dirty rectangles.
+   * @return count.
+   */
+  uint8_t dirty() const
+  {
+    return (m_count);
+  }
+
+  /**
+   * Repaint dirty rectangles and clear the damage list.
+   */
+  void flush();
+
+  /**
+   * Return number of pixels drawn by repaint() since latest reset.
+   * @return pixels.
+   */
+  uint32_t drawn() const
+  {
+    return (m_drawn);
+  }
+
+  /**
+   * Return number of pixels pushed to the device since latest reset.
+   * @return pixels.
+   */
+  uint32_t pushed() const
+  {
+    return (m_pushed);
+  }
+
+  /**
+   * Reset pixel counters.
+   */
+  void reset()
+  {
+    m_drawn = 0;
+    m_pushed = 0;
+  }
+
+  /**
+   * @override{Damage}
+   * Draw the scene. Called by flush() for each dirty rectangle.
+   */
+  virtual void repaint() = 0;
+
+  /**
+   * @override{Canvas}
+   * Start interaction with device. The whole canvas is damaged.
+   * @return true(1) if successful otherwise false(0).
+   */
+  virtual bool begin();
+
+  /**
+   * @override{Canvas}
+   * Set device orientation. The whole canvas is damaged.
+   * @param[in] direction (Canvas::LANDSCAPE/PORTRAIT).
+   * @return previous orientation.
+   */
+  virtual uint8_t set_orientation(uint8_t direction);
+
+  /**
+   * @override{Canvas}
+   * Record damage or forward clipped pixel.
+   * @param[in] x.
+   * @param[in] y.
+   */
+  virtual void draw_pixel(uint16_t x, uint16_t y);
+  using Canvas::draw_pixel;
+
+  /**
+   * @override{Canvas}
+   * Record damage or draw bitmap within clip.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] bp.
+   * @param[in] width.
+   * @param[in] height.
+   * @param[in] scale.
+   */
+  virtual void draw_bitmap(uint16_t x, uint16_t y, const uint8_t* bp,
+			   uint16_t width, uint16_t height,
+			   uint8_t scale = 1);
+  using Canvas::draw_bitmap;
+
+  /**
+   * @override{Canvas}
+   * Record damage or draw image; forwarded when within clip.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] image.
+   */
+  virtual void draw_image(uint16_t x, uint16_t y, Image* image);
+  using Canvas::draw_image;
+
+  /**
+   * @override{Canvas}
+   * Record damage or draw line within clip.
+   * @param[in] x0.
+   * @param[in] y0.
+   * @param[in] x1.
+   * @param[in] y1.
+   */
+  virtual void draw_line(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+  using Canvas::draw_line;
+
+  /**
+   * @override{Canvas}
+   * Record damage or forward clipped vertical line.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] length.
+   */
+  virtual void draw_vertical_line(uint16_t x, uint16_t y, uint16_t length);
+  using Canvas::draw_vertical_line;
+
+  /**
+   * @override{Canvas}
+   * Record damage or forward clipped horizontal line.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] length.
+   */
+  virtual void draw_horizontal_line(uint16_t x, uint16_t y, uint16_t length);
+  using Canvas::draw_horizontal_line;
+
+  /**
+   * @override{Canvas}
+   * Record damage or forward clipped rectangle.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] width.
+   * @param[in] height.
+   */
+  virtual void fill_rect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+  using Canvas::fill_rect;
+
+  /**
+   * @override{Canvas}
+   * Record damage or draw round rectangle within clip.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] width.
+   * @param[in] height.
+   * @param[in] radius.
+   */
+  virtual void draw_roundrect(uint16_t x, uint16_t y,
+			      uint16_t width, uint16_t height,
+			      uint16_t radius);
+  using Canvas::draw_roundrect;
+
+  /**
+   * @override{Canvas}
+   * Record damage or fill round rectangle within clip.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] width.
+   * @param[in] height.
+   * @param[in] radius.
+   */
+  virtual void fill_roundrect(uint16_t x, uint16_t y,
+			      uint16_t width, uint16_t height,
+			      uint16_t radius);
+  using Canvas::fill_roundrect;
+
+  /**
+   * @override{Canvas}
+   * Record damage or draw circle within clip.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] radius.
+   */
+  virtual void draw_circle(uint16_t x, uint16_t y, uint16_t radius);
+  using Canvas::draw_circle;
+
+  /**
+   * @override{Canvas}
+   * Record damage or fill circle within clip.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] radius.
+   */
+  virtual void fill_circle(uint16_t x, uint16_t y, uint16_t radius);
+  using Canvas::fill_circle;
+
+  /**
+   * @override{Canvas}
+   * Record damage or draw character; forwarded to the device when
+   * the character cell is within clip.
+   * @param[in] x position.
+   * @param[in] y position.
+   * @param[in] c character.
+   */
+  virtual void draw_char(uint16_t x, uint16_t y, char c);
+  using Canvas::draw_char;
+
+  /**
+   * @override{Canvas}
+   * Stop sequence of interaction with device.
+   * @return true(1) if successful otherwise false(0).
+   */
+  virtual bool end();
+
+protected:
+  /** Canvas device. */
+  Canvas* m_canvas;
+
+  /** Dirty rectangles. */
+  rect16_t m_damage[DAMAGE_MAX];
+
+  /** Number of dirty rectangles. */
+  uint8_t m_count;
+
+  /** Current clip rectangle during flush. */
+  rect16_t m_clip;
+
+  /** Repaint in progress. */
+  bool m_flushing;
+
+  /** Number of pixels drawn. */
+  uint32_t m_drawn;
+
+  /** Number of pixels pushed to device. */
+  uint32_t m_pushed;
+
+  /**
+   * Check bounding rectangle of a drawing operation. Record damage
+   * and return false(0) when not flushing. Otherwise return true(1)
+   * if the rectangle intersects the clip.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] width.
+   * @param[in] height.
+   * @return bool.
+   */
+  bool visible(int16_t x, int16_t y, uint16_t width, uint16_t height);
+
+  /**
+   * Check rectangle of a device operation. Record damage and return
+   * false(0) when not flushing. Otherwise clip the rectangle, update
+   * pixel counters and return true(1) if not empty.
+   * @param[in,out] rect rectangle to clip.
+   * @return bool.
+   */
+  bool push(rect16_t& rect);
+};
+
+#endif
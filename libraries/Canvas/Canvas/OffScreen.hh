@@ -22,21 +22,45 @@
 #define COSA_CANVAS_OFFSCREEN_HH
 
 #include "Cosa/Types.h"
+#include "Font.hh"
 
 /**
  * Off-screen canvas for drawing before copying to the canvas device.
- * Supports monochrome, 1-bit, pixel in off-screen buffer. Minimum
- * implementation; draw_pixel() only.
+ * Supports monochrome, 1-bit, pixel in off-screen buffer. The buffer
+ * is organized in pages of eight pixel rows with one byte per column;
+ * the memory layout of PCD8544 and ST7565 display RAM. Pixels, lines,
+ * rectangles and characters are drawn with byte mask operations in
+ * memory. Modified pages and columns are tracked and flush() copies
+ * only the dirty region to the display device, one burst per page.
+ * Black pen color sets pixels, other colors clear pixels.
  * @param[in] width of canvas.
  * @param[in] height of canvas.
+ *
+ * @section Usage
+ * @code
+ * OffScreen<PCD8544::WIDTH, PCD8544::HEIGHT> offscreen;
+ * ...
+ * offscreen.begin();
+ * offscreen.draw_rect(0, 0, 10, 10);
+ * offscreen.flush(&lcd);
+ * @endcode
  */
 template<uint16_t width, uint16_t height>
 class OffScreen : public Canvas {
 public:
+  /** Number of pages (eight pixel rows). */
+  static const uint8_t PAGES = (height + (CHARBITS - 1)) / CHARBITS;
+
   /**
    * Construct off-screen canvas with given width and height.
    */
-  OffScreen() : Canvas(width, height) {}
+  OffScreen() :
+    Canvas(width, height),
+    m_x0(width),
+    m_x1(0)
+  {
+    memset(m_dirty, 0, sizeof(m_dirty));
+  }
 
   /**
    * Get bitmap for the off-screen canvas.
@@ -47,6 +71,36 @@ public:
     return (m_bitmap);
   }
 
+  /**
+   * Return true(1) if the off-screen canvas has been modified since
+   * the latest flush otherwise false(0).
+   * @return bool.
+   */
+  bool is_dirty() const
+  {
+    return (m_x0 < m_x1);
+  }
+
+  /**
+   * Mark given region as modified. The region is clipped.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] w width.
+   * @param[in] h height.
+   */
+  void mark(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+  {
+    if (UNLIKELY((x >= width) || (y >= height) || (w == 0) || (h == 0)))
+      return;
+    if (w > width - x) w = width - x;
+    if (h > height - y) h = height - y;
+    if (x < m_x0) m_x0 = x;
+    if (x + w > m_x1) m_x1 = x + w;
+    uint8_t last = (y + h - 1) >> 3;
+    for (uint8_t page = y >> 3; page <= last; page++)
+      m_dirty[page >> 3] |= _BV(page & 0x07);
+  }
+
   /**
    * @override{Canvas}
    * Start interaction with off-screen canvas.
@@ -66,8 +120,9 @@ public:
    */
   virtual void draw_pixel(uint16_t x, uint16_t y)
   {
-    if (UNLIKELY((x > WIDTH) || (y > HEIGHT))) return;
-    uint8_t* bp = &m_bitmap[((y >> 3) * WIDTH) + x];
+    if (UNLIKELY((x >= width) || (y >= height))) return;
+    mark(x, y, 1, 1);
+    uint8_t* bp = &m_bitmap[((y >> 3) * width) + x];
     uint8_t pos = (y & 0x07);
     if (get_pen_color().rgb == Canvas::BLACK)
       *bp |= (1 << pos);
@@ -75,13 +130,131 @@ public:
       *bp &= ~(1 << pos);
   }
 
+  /**
+   * @override{Canvas}
+   * Draw vertical line with current pen color.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] length.
+   */
+  virtual void draw_vertical_line(uint16_t x, uint16_t y, uint16_t length)
+  {
+    fill_rect(x, y, 1, length);
+  }
+
+  /**
+   * @override{Canvas}
+   * Draw horizontal line with current pen color.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] length.
+   */
+  virtual void draw_horizontal_line(uint16_t x, uint16_t y, uint16_t length)
+  {
+    fill_rect(x, y, length, 1);
+  }
+
+  /**
+   * @override{Canvas}
+   * Fill rectangle with current pen color. Each page is updated with
+   * a byte mask per column.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] w width.
+   * @param[in] h height.
+   */
+  virtual void fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+  {
+    if (UNLIKELY((x >= width) || (y >= height) || (w == 0) || (h == 0)))
+      return;
+    if (w > width - x) w = width - x;
+    if (h > height - y) h = height - y;
+    mark(x, y, w, h);
+    bool set = (get_pen_color().rgb == Canvas::BLACK);
+    uint16_t last = y + h;
+    uint8_t* row = &m_bitmap[((y >> 3) * width) + x];
+    while (y < last) {
+      uint8_t mask = (0xff << (y & 0x07));
+      uint16_t next = (y | 0x07) + 1;
+      if (next > last) {
+	mask &= (0xff >> (next - last));
+	next = last;
+      }
+      uint8_t* bp = row;
+      uint16_t n = w;
+      if (set) {
+	do *bp++ |= mask; while (--n);
+      }
+      else {
+	mask = ~mask;
+	do *bp++ &= mask; while (--n);
+      }
+      row += width;
+      y = next;
+    }
+  }
+
+  /**
+   * @override{Canvas}
+   * Draw character with current text color, font, scale and mode.
+   * Unscaled glyph columns are merged directly into the pages.
+   * @param[in] x position.
+   * @param[in] y position.
+   * @param[in] c character.
+   */
+  virtual void draw_char(uint16_t x, uint16_t y, char c)
+  {
+    if (get_text_scale() != 1) {
+      Canvas::draw_char(x, y, c);
+      return;
+    }
+    Font* font = get_text_font();
+    uint16_t advance = font->WIDTH + font->SPACING;
+    if (get_text_opaque()) {
+      color16_t saved = set_pen_color(get_canvas_color());
+      fill_rect(x, y, advance, font->HEIGHT);
+      set_pen_color(saved);
+    }
+    bool set = (get_text_color().rgb == Canvas::BLACK);
+    Font::Glyph glyph(font, c);
+    mark(x, y, font->WIDTH, font->HEIGHT);
+    for (uint16_t i = 0; i < font->HEIGHT; i += CHARBITS)
+      for (uint16_t j = 0; j < font->WIDTH; j++)
+	merge(x + j, y + i, glyph.next(), set);
+    set_cursor(x + advance, y);
+  }
+  using Canvas::draw_char;
+
   /**
    * @override{Canvas}
    * Fill offscreen buffer with canvas background color.
    */
   virtual void fill_screen()
   {
-    memset(m_bitmap, (get_canvas_color().rgb == Canvas::BLACK), COUNT);
+    memset(m_bitmap, (get_canvas_color().rgb == Canvas::BLACK) ? 0xff : 0, COUNT);
+    mark(0, 0, width, height);
+  }
+
+  /**
+   * Copy the modified region to the given display device and clear
+   * the modification state. The device should support set_cursor()
+   * with page position and draw_bitmap() (e.g. PCD8544 and ST7565).
+   * @param[in] dev display device.
+   */
+  template<class DEVICE>
+  void flush(DEVICE* dev)
+  {
+    if (m_x0 >= m_x1) return;
+    uint8_t x = m_x0;
+    uint8_t w = m_x1 - m_x0;
+    for (uint8_t page = 0; page < PAGES; page++) {
+      if ((m_dirty[page >> 3] & _BV(page & 0x07)) == 0) continue;
+      dev->set_cursor(x, page);
+      dev->draw_bitmap(&m_bitmap[(page * width) + x], w, CHARBITS);
+    }
+    memset(m_dirty, 0, sizeof(m_dirty));
+    m_x0 = width;
+    m_x1 = 0;
   }
 
   /**
@@ -95,8 +268,31 @@ public:
   }
 
 private:
-  static const uint16_t COUNT = (width * height) / CHARBITS;
+  static const uint16_t COUNT = width * PAGES;
   uint8_t m_bitmap[COUNT];
+  uint8_t m_dirty[(PAGES + (CHARBITS - 1)) / CHARBITS];
+  uint16_t m_x0;
+  uint16_t m_x1;
+
+  /**
+   * Merge glyph column (eight pixels) at given position. The column
+   * may span two pages.
+   * @param[in] x.
+   * @param[in] y.
+   * @param[in] bits column pixels.
+   * @param[in] set pixels (true) or clear pixels (false).
+   */
+  void merge(uint16_t x, uint16_t y, uint8_t bits, bool set)
+  {
+    if (UNLIKELY((x >= width) || (y >= height) || (bits == 0))) return;
+    uint8_t page = (y >> 3);
+    uint16_t column = ((uint16_t) bits) << (y & 0x07);
+    uint8_t* bp = &m_bitmap[(page * width) + x];
+    if (set) *bp |= column; else *bp &= ~column;
+    if ((column >> 8) == 0 || (page + 1 >= PAGES)) return;
+    bp += width;
+    if (set) *bp |= (column >> 8); else *bp &= ~(column >> 8);
+  }
 };
 
 #endif
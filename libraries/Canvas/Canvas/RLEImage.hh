@@ -0,0 +1,138 @@
+/**
+ * @file Canvas/RLEImage.hh
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#ifndef COSA_CANVAS_RLE_IMAGE_HH
+#define COSA_CANVAS_RLE_IMAGE_HH
+
+#include "Cosa/Types.h"
+#include "Cosa/IOStream.hh"
+#include <Canvas.h>
+
+/**
+ * Run-length encoded, optionally palette indexed, canvas image. The
+ * image is decoded on the fly from an IOStream device (e.g. FAT16 or
+ * CFFS file) and delivered as color runs with read_run(); canvas
+ * devices such as GDDRAM write each run directly to display memory.
+ *
+ * The image format is little-endian:
+ * @code
+ *   header: 'R' 'L' width:16 height:16 colors:8 palette:16[colors]
+ *   packet: 1nnnnnnn pixel      run of n + 1 pixels of pixel color
+ *           0nnnnnnn pixel*     n + 1 literal pixels
+ * @endcode
+ * Pixels are palette indexes (8-bit) when colors is non-zero,
+ * otherwise 16-bit RGB<5,6,5> colors. The palette size is limited to
+ * PALETTE_MAX colors. Packets may span rows; pixels are in scanning
+ * order from left to right, top to bottom.
+ */
+class RLEImage : public Canvas::Image {
+public:
+  /** Max number of palette colors. */
+  static const uint8_t PALETTE_MAX = 16;
+
+  /** Image file signature. */
+  static const uint16_t SIGNATURE = 0x4c52;
+
+  /**
+   * Construct run-length encoded image reading from given device.
+   * @param[in] dev input device.
+   */
+  RLEImage(IOStream::Device* dev) :
+    Canvas::Image(),
+    m_dev(dev),
+    m_colors(0),
+    m_count(0),
+    m_literal(false)
+  {}
+
+  /**
+   * Read and check image header and palette. Return true(1) if
+   * successful otherwise false(0).
+   * @return bool.
+   */
+  bool begin();
+
+  /**
+   * @override{Canvas::Image}
+   * Read the given number of pixel into the given buffer.
+   * Return true(1) if successful otherwise false(0).
+   * @param[in] buf pixel buffer pointer.
+   * @param[in] count number of pixels to read.
+   * @return bool.
+   */
+  virtual bool read(Canvas::color16_t* buf, size_t count);
+
+  /**
+   * @override{Canvas::Image}
+   * Read next run of pixels with the same color, at most given
+   * number of pixels. Return number of pixels or zero(0) on error.
+   * @param[out] color of run.
+   * @param[in] max number of pixels.
+   * @return number of pixels.
+   */
+  virtual size_t read_run(Canvas::color16_t& color, size_t max);
+
+  /**
+   * @override{Canvas::Image}
+   * Return true(1); the image is drawn with read_run().
+   * @return bool.
+   */
+  virtual bool is_compressed() const
+  {
+    return (true);
+  }
+
+protected:
+  /** Input device. */
+  IOStream::Device* m_dev;
+
+  /** Color palette. */
+  uint16_t m_palette[PALETTE_MAX];
+
+  /** Number of palette colors; zero(0) for direct color. */
+  uint8_t m_colors;
+
+  /** Number of pixels left in current packet. */
+  uint8_t m_count;
+
+  /** Current packet is literal pixels. */
+  bool m_literal;
+
+  /** Current run color. */
+  Canvas::color16_t m_color;
+
+  /**
+   * Read 16-bit little-endian value. Return true(1) if successful
+   * otherwise false(0).
+   * @param[out] value.
+   * @return bool.
+   */
+  bool read16(uint16_t& value);
+
+  /**
+   * Read pixel; palette index or direct color. Return true(1) if
+   * successful otherwise false(0).
+   * @param[out] color.
+   * @return bool.
+   */
+  bool read_pixel(Canvas::color16_t& color);
+};
+
+#endif
@@ -0,0 +1,322 @@
+/**
+ * @file Damage.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Canvas/Damage.hh"
+#include "Font.hh"
+
+/**
+ * Return number of pixels in given rectangle.
+ * @param[in] r rectangle.
+ * @return pixels.
+ */
+static uint32_t
+area(const Canvas::rect16_t& r)
+{
+  return (((uint32_t) r.width) * r.height);
+}
+
+/**
+ * Extend the first rectangle to the bounding rectangle of both.
+ * @param[in,out] r rectangle to extend.
+ * @param[in] s rectangle.
+ */
+static void
+unite(Canvas::rect16_t& r, const Canvas::rect16_t& s)
+{
+  uint16_t x1 = r.x + r.width;
+  uint16_t y1 = r.y + r.height;
+  if (s.x + s.width > x1) x1 = s.x + s.width;
+  if (s.y + s.height > y1) y1 = s.y + s.height;
+  if (s.x < r.x) r.x = s.x;
+  if (s.y < r.y) r.y = s.y;
+  r.width = x1 - r.x;
+  r.height = y1 - r.y;
+}
+
+void
+Damage::mark(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+  // Clip to the canvas
+  if (UNLIKELY((width == 0) || (height == 0))) return;
+  if (UNLIKELY((x >= WIDTH) || (y >= HEIGHT))) return;
+  if (width > WIDTH - x) width = WIDTH - x;
+  if (height > HEIGHT - y) height = HEIGHT - y;
+  rect16_t r = { x, y, width, height };
+
+  while (1) {
+    // Merge with dirty rectangles while the union does not add pixels
+    uint8_t i = 0;
+    while (i < m_count) {
+      rect16_t u = r;
+      unite(u, m_damage[i]);
+      if (area(u) <= area(r) + area(m_damage[i])) {
+	r = u;
+	m_damage[i] = m_damage[--m_count];
+	i = 0;
+      }
+      else i++;
+    }
+
+    // Append if there is room in the damage list
+    if (m_count < DAMAGE_MAX) {
+      m_damage[m_count++] = r;
+      return;
+    }
+
+    // Otherwise merge with the entry that grows the least and retry
+    uint8_t best = 0;
+    uint32_t growth = UINT32_MAX;
+    for (i = 0; i < m_count; i++) {
+      rect16_t u = m_damage[i];
+      unite(u, r);
+      uint32_t g = area(u) - area(m_damage[i]);
+      if (g < growth) {
+	growth = g;
+	best = i;
+      }
+    }
+    unite(r, m_damage[best]);
+    m_damage[best] = m_damage[--m_count];
+  }
+}
+
+void
+Damage::flush()
+{
+  if (m_count == 0) return;
+  Context* saved = m_canvas->set_context(m_context);
+  m_flushing = true;
+  while (m_count != 0) {
+    m_clip = m_damage[--m_count];
+    repaint();
+  }
+  m_flushing = false;
+  m_canvas->set_context(saved);
+}
+
+bool
+Damage::visible(int16_t x, int16_t y, uint16_t width, uint16_t height)
+{
+  // Adjust negative position
+  if (x < 0) {
+    if (width <= (uint16_t) -x) return (false);
+    width += x;
+    x = 0;
+  }
+  if (y < 0) {
+    if (height <= (uint16_t) -y) return (false);
+    height += y;
+    y = 0;
+  }
+
+  // Record damage
+  if (!m_flushing) {
+    mark(x, y, width, height);
+    return (false);
+  }
+
+  // Check intersection with clip; count pixels not drawn
+  if ((width != 0) && (height != 0)
+      && ((uint16_t) x < m_clip.x + m_clip.width)
+      && ((uint16_t) x + width > m_clip.x)
+      && ((uint16_t) y < m_clip.y + m_clip.height)
+      && ((uint16_t) y + height > m_clip.y))
+    return (true);
+  m_drawn += ((uint32_t) width) * height;
+  return (false);
+}
+
+bool
+Damage::push(rect16_t& rect)
+{
+  // Record damage
+  if (!m_flushing) {
+    mark(rect.x, rect.y, rect.width, rect.height);
+    return (false);
+  }
+
+  // Clip the rectangle and count pixels
+  m_drawn += area(rect);
+  uint16_t x1 = rect.x + rect.width;
+  uint16_t y1 = rect.y + rect.height;
+  uint16_t cx1 = m_clip.x + m_clip.width;
+  uint16_t cy1 = m_clip.y + m_clip.height;
+  if (rect.x < m_clip.x) rect.x = m_clip.x;
+  if (rect.y < m_clip.y) rect.y = m_clip.y;
+  if (x1 > cx1) x1 = cx1;
+  if (y1 > cy1) y1 = cy1;
+  if ((x1 <= rect.x) || (y1 <= rect.y)) return (false);
+  rect.width = x1 - rect.x;
+  rect.height = y1 - rect.y;
+  m_pushed += area(rect);
+  return (true);
+}
+
+bool
+Damage::begin()
+{
+  mark();
+  return (m_canvas->begin());
+}
+
+uint8_t
+Damage::set_orientation(uint8_t direction)
+{
+  uint8_t previous = m_canvas->set_orientation(direction);
+  m_direction = direction;
+  WIDTH = m_canvas->WIDTH;
+  HEIGHT = m_canvas->HEIGHT;
+  m_count = 0;
+  mark();
+  return (previous);
+}
+
+void
+Damage::draw_pixel(uint16_t x, uint16_t y)
+{
+  rect16_t r = { x, y, 1, 1 };
+  if (!push(r)) return;
+  m_canvas->draw_pixel(x, y);
+}
+
+void
+Damage::draw_bitmap(uint16_t x, uint16_t y, const uint8_t* bp,
+		    uint16_t width, uint16_t height,
+		    uint8_t scale)
+{
+  uint16_t rows = (height + (CHARBITS - 1)) & ~(CHARBITS - 1);
+  if (!visible(x, y, width * scale, rows * scale)) return;
+  Canvas::draw_bitmap(x, y, bp, width, height, scale);
+}
+
+void
+Damage::draw_image(uint16_t x, uint16_t y, Image* image)
+{
+  rect16_t r = { x, y, image->WIDTH, image->HEIGHT };
+  if (!visible(x, y, r.width, r.height)) return;
+  if ((x >= m_clip.x) && (y >= m_clip.y)
+      && (x + r.width <= m_clip.x + m_clip.width)
+      && (y + r.height <= m_clip.y + m_clip.height)) {
+    push(r);
+    m_canvas->draw_image(x, y, image);
+  }
+  else Canvas::draw_image(x, y, image);
+}
+
+void
+Damage::draw_line(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  uint16_t x = (x0 < x1) ? x0 : x1;
+  uint16_t y = (y0 < y1) ? y0 : y1;
+  uint16_t width = ((x0 < x1) ? x1 - x0 : x0 - x1) + 1;
+  uint16_t height = ((y0 < y1) ? y1 - y0 : y0 - y1) + 1;
+  if (!visible(x, y, width, height)) return;
+  Canvas::draw_line(x0, y0, x1, y1);
+}
+
+void
+Damage::draw_vertical_line(uint16_t x, uint16_t y, uint16_t length)
+{
+  rect16_t r = { x, y, 1, length };
+  if (!push(r)) return;
+  m_canvas->draw_vertical_line(r.x, r.y, r.height);
+}
+
+void
+Damage::draw_horizontal_line(uint16_t x, uint16_t y, uint16_t length)
+{
+  rect16_t r = { x, y, length, 1 };
+  if (!push(r)) return;
+  m_canvas->draw_horizontal_line(r.x, r.y, r.width);
+}
+
+void
+Damage::fill_rect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+  rect16_t r = { x, y, width, height };
+  if (!push(r)) return;
+  m_canvas->fill_rect(r.x, r.y, r.width, r.height);
+}
+
+void
+Damage::draw_roundrect(uint16_t x, uint16_t y,
+		       uint16_t width, uint16_t height,
+		       uint16_t radius)
+{
+  if (!visible(x, y, width + 1, height + 1)) return;
+  Canvas::draw_roundrect(x, y, width, height, radius);
+}
+
+void
+Damage::fill_roundrect(uint16_t x, uint16_t y,
+		       uint16_t width, uint16_t height,
+		       uint16_t radius)
+{
+  if (!visible(x, y, width + 1, height + 1)) return;
+  Canvas::fill_roundrect(x, y, width, height, radius);
+}
+
+void
+Damage::draw_circle(uint16_t x, uint16_t y, uint16_t radius)
+{
+  uint16_t diameter = 2 * radius + 1;
+  if (!visible(x - radius, y - radius, diameter, diameter)) return;
+  Canvas::draw_circle(x, y, radius);
+}
+
+void
+Damage::fill_circle(uint16_t x, uint16_t y, uint16_t radius)
+{
+  uint16_t diameter = 2 * radius + 1;
+  if (!visible(x - radius, y - radius, diameter, diameter)) return;
+  Canvas::fill_circle(x, y, radius);
+}
+
+void
+Damage::draw_char(uint16_t x, uint16_t y, char c)
+{
+  Font* font = get_text_font();
+  uint8_t scale = get_text_scale();
+  rect16_t r = { x, y,
+		 (uint16_t) (scale * (font->WIDTH + font->SPACING)),
+		 (uint16_t) (scale * font->HEIGHT) };
+
+  // Forward to the device when the character cell is within clip
+  if (m_flushing
+      && (x >= m_clip.x) && (y >= m_clip.y)
+      && (x + r.width <= m_clip.x + m_clip.width)
+      && (y + r.height <= m_clip.y + m_clip.height)) {
+    push(r);
+    m_canvas->draw_char(x, y, c);
+    return;
+  }
+
+  // Otherwise record damage or draw the visible part
+  if (visible(x, y, r.width, r.height))
+    Canvas::draw_char(x, y, c);
+  else
+    set_cursor(x + r.width, y);
+}
+
+bool
+Damage::end()
+{
+  return (m_canvas->end());
+}
@@ -0,0 +1,104 @@
+/**
+ * @file RLEImage.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Canvas/RLEImage.hh"
+
+bool
+RLEImage::read16(uint16_t& value)
+{
+  int low = m_dev->getchar();
+  if (UNLIKELY(low < 0)) return (false);
+  int high = m_dev->getchar();
+  if (UNLIKELY(high < 0)) return (false);
+  value = (high << 8) | low;
+  return (true);
+}
+
+bool
+RLEImage::read_pixel(Canvas::color16_t& color)
+{
+  // Direct color
+  if (m_colors == 0) return (read16(color.rgb));
+
+  // Palette index
+  int ix = m_dev->getchar();
+  if (UNLIKELY((ix < 0) || (ix >= m_colors))) return (false);
+  color.rgb = m_palette[ix];
+  return (true);
+}
+
+bool
+RLEImage::begin()
+{
+  // Read and check header
+  uint16_t signature;
+  if (!read16(signature) || (signature != SIGNATURE)) return (false);
+  if (!read16(WIDTH) || !read16(HEIGHT)) return (false);
+  int colors = m_dev->getchar();
+  if (UNLIKELY((colors < 0) || (colors > PALETTE_MAX))) return (false);
+
+  // Read palette
+  m_colors = colors;
+  for (uint8_t i = 0; i < m_colors; i++)
+    if (!read16(m_palette[i])) return (false);
+  m_count = 0;
+  return (true);
+}
+
+size_t
+RLEImage::read_run(Canvas::color16_t& color, size_t max)
+{
+  if (UNLIKELY(max == 0)) return (0);
+
+  // Read next packet header; run color is read once
+  if (m_count == 0) {
+    int header = m_dev->getchar();
+    if (UNLIKELY(header < 0)) return (0);
+    m_literal = (header & 0x80) == 0;
+    m_count = (header & 0x7f) + 1;
+    if (!m_literal && !read_pixel(m_color)) return (0);
+  }
+
+  // Literal pixels are single pixel runs
+  if (m_literal) {
+    if (!read_pixel(color)) return (0);
+    m_count -= 1;
+    return (1);
+  }
+
+  // Run of pixels; possibly split by max
+  size_t count = (m_count < max) ? m_count : max;
+  color = m_color;
+  m_count -= count;
+  return (count);
+}
+
+bool
+RLEImage::read(Canvas::color16_t* buf, size_t count)
+{
+  while (count != 0) {
+    Canvas::color16_t color;
+    size_t n = read_run(color, count);
+    if (UNLIKELY(n == 0)) return (false);
+    count -= n;
+    while (n--) *buf++ = color;
+  }
+  return (true);
+}
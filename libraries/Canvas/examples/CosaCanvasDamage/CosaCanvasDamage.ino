@@ -0,0 +1,129 @@
+/**
+ * @file CosaCanvasDamage.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Cosa demonstration of Canvas damage tracking and partial refresh.
+ * A status panel with a frame, a title and two counters is repainted.
+ * Only the counter fields are damaged on update and pushed to the
+ * display. The number of pixels drawn and pushed is printed.
+ *
+ * @section Circuit
+ * See CosaCanvasFont for display connections.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "Cosa/Watchdog.hh"
+#include "Cosa/RTT.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/UART.hh"
+
+#include <Canvas.h>
+#include "Canvas/Damage.hh"
+
+#include <GDDRAM.h>
+#include <ILI9341.h>
+ILI9341 tft;
+
+class Panel : public Damage {
+public:
+  Panel(Canvas* canvas) :
+    Damage(canvas),
+    m_ticks(0),
+    m_events(0)
+  {}
+
+  void update(uint16_t ticks, uint16_t events)
+  {
+    if (ticks != m_ticks) fill_rect(FIELD_X, 40, FIELD_WIDTH, 16);
+    if (events != m_events) fill_rect(FIELD_X, 60, FIELD_WIDTH, 16);
+    m_ticks = ticks;
+    m_events = events;
+  }
+
+  virtual void repaint()
+  {
+    set_canvas_color(Canvas::WHITE);
+    set_text_opaque(true);
+    fill_screen();
+    set_pen_color(Canvas::BLACK);
+    draw_roundrect(4, 4, WIDTH - 9, 80, 8);
+    set_text_color(Canvas::BLUE);
+    set_text_scale(2);
+    set_cursor(12, 12);
+    draw_string((str_P) TITLE);
+    set_text_color(Canvas::BLACK);
+    set_cursor(12, 40);
+    draw_string((str_P) TICKS);
+    draw_number(m_ticks);
+    set_cursor(12, 60);
+    draw_string((str_P) EVENTS);
+    draw_number(m_events);
+  }
+
+protected:
+  static const uint16_t FIELD_X = 12 + 7 * 12;
+  static const uint16_t FIELD_WIDTH = 5 * 12;
+  static const char TITLE[];
+  static const char TICKS[];
+  static const char EVENTS[];
+  uint16_t m_ticks;
+  uint16_t m_events;
+
+  void draw_number(uint16_t value)
+  {
+    char buf[6];
+    utoa(value, buf, 10);
+    draw_string(buf);
+  }
+};
+
+const char Panel::TITLE[] __PROGMEM = "Status";
+const char Panel::TICKS[] __PROGMEM = "ticks: ";
+const char Panel::EVENTS[] __PROGMEM = "event: ";
+
+Panel panel(&tft);
+
+void setup()
+{
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaCanvasDamage: started"));
+  Watchdog::begin();
+  RTT::begin();
+  panel.begin();
+  panel.flush();
+  trace << PSTR("full:drawn=") << panel.drawn()
+	<< PSTR(",pushed=") << panel.pushed()
+	<< endl;
+}
+
+void loop()
+{
+  static uint16_t events = 0;
+  uint16_t ticks = RTT::millis() / 1000;
+  if ((ticks & 3) == 0) events += 1;
+  panel.reset();
+  uint32_t start = RTT::millis();
+  panel.update(ticks, events);
+  panel.flush();
+  uint32_t ms = RTT::since(start);
+  trace << PSTR("update:drawn=") << panel.drawn()
+	<< PSTR(",pushed=") << panel.pushed()
+	<< PSTR(",ms=") << ms
+	<< endl;
+  sleep(1);
+}
@@ -153,8 +153,9 @@ void setup()
   Watchdog::begin();
   RTT::begin();
 
-  // Initiate the display
+  // Initiate the display. Draw text with background (window write)
   TRACE(tft.begin());
+  textbox.set_text_opaque(true);
 }
 
 void loop()
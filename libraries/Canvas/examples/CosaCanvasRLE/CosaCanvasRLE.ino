@@ -0,0 +1,102 @@
+/**
+ * @file CosaCanvasRLE.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Cosa demonstration of drawing a run-length encoded, palette
+ * indexed, image (SPLASH.RLE) on Canvas. The image is streamed from
+ * the SD card and each color run is written to the display with a
+ * single windowed write. See Canvas/RLEImage.hh for the file format.
+ *
+ * @section Circuit
+ * @code
+ *                           ST7735
+ *                       +------------+
+ * (GND)---------------1-|GND         |
+ * (VCC)---------------2-|VCC         |
+ *                      -|            |
+ * (RST)---------------6-|RESET       |
+ * (D9)----------------7-|A0          |
+ * (MOSI/D11)----------8-|SDA         |
+ * (SCK/D13)-----------9-|SCK         |
+ * (SS/D10)-----------10-|CS          |
+ *                      -|            |
+ * (VCC)----[330]-----15-|LED+        |
+ * (GND)--------------16-|LED-        |
+ *                       +------------+
+ * @endcode
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include <SD.h>
+#include <FAT16.h>
+#include <Canvas.h>
+#include "Canvas/RLEImage.hh"
+#include <GDDRAM.h>
+#include <ST7735.h>
+
+#include "Cosa/RTT.hh"
+#include "Cosa/Watchdog.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/IOStream.hh"
+#include "Cosa/UART.hh"
+
+SD sd(Board::D8);
+ST7735 tft;
+
+void setup()
+{
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaCanvasRLE: started"));
+  Watchdog::begin();
+  RTT::begin();
+  ASSERT(sd.begin(SPI::DIV2_CLOCK));
+  ASSERT(FAT16::begin(&sd));
+  ASSERT(tft.begin());
+}
+
+void loop()
+{
+  uint32_t pixels = 0L;
+  FAT16::File file;
+  RLEImage image(&file);
+
+  MEASURE("fill screen:", 1) {
+    tft.set_canvas_color(Canvas::BLUE);
+    tft.fill_screen();
+  }
+
+  MEASURE("open image file:", 1) {
+    ASSERT(file.open("SPLASH.RLE", O_READ));
+    ASSERT(image.begin());
+  }
+  INFO("image width: %ud", image.WIDTH);
+  INFO("image height: %ud", image.HEIGHT);
+  INFO("image pixels: %ul", pixels = ((uint32_t) image.WIDTH) * image.HEIGHT);
+  INFO("file size: %ul", file.size());
+
+  MEASURE("draw image:", 1) {
+    tft.draw_image(0, 0, &image);
+  }
+  INFO("draw pixel: %ul us", trace.measure / pixels);
+
+  MEASURE("close image file:", 1) {
+    ASSERT(file.close());
+  }
+
+  ASSERT(true == false);
+}
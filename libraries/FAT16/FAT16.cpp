@@ -58,10 +58,10 @@ uint32_t FAT16::fatStartBlock;
 uint32_t FAT16::rootDirStartBlock;
 uint32_t FAT16::dataStartBlock;
 
-uint32_t FAT16::cacheBlockNumber = 0XFFFFFFFF;
-FAT16::cache16_t FAT16::cacheBuffer;
-uint8_t FAT16::cacheDirty = 0;
-uint32_t FAT16::cacheMirrorBlock = 0;
+FAT16::cache_t FAT16::cache[CACHE_MAX];
+uint8_t FAT16::cacheLast = 0;
+uint16_t FAT16::cacheClock = 0;
+FAT16::cache_stat_t FAT16::cacheStat;
 void (*FAT16::dateTime)(uint16_t* date, uint16_t* time) = NULL;
 
 bool
@@ -69,22 +69,28 @@ FAT16::begin(SD* sd, uint8_t part)
 {
   // Error if invalid partition
   if (UNLIKELY(part > 4)) return (false);
+
+  // Write any modified blocks and reset the cache
+  if (!cacheFlush()) return (false);
+  cacheInvalidate();
+  volumeInitialized = false;
   device = sd;
   uint32_t volumeStartBlock = 0;
+  cache16_t* cb;
 
   // If part == 0 assume super floppy with FAT16 boot sector in block zero
   // If part > 0 assume mbr volume with partition table
   if (part) {
-    if (!cacheRawBlock(volumeStartBlock)) return (false);
-    volumeStartBlock = cacheBuffer.mbr.part[part - 1].firstSector;
+    if (!(cb = cacheRawBlock(volumeStartBlock))) return (false);
+    volumeStartBlock = cb->mbr.part[part - 1].firstSector;
   }
-  if (!cacheRawBlock(volumeStartBlock)) return (false);
+  if (!(cb = cacheRawBlock(volumeStartBlock))) return (false);
 
   // Check boot block signature
-  if (cacheBuffer.data[510] != BOOTSIG0 ||
-      cacheBuffer.data[511] != BOOTSIG1) return (false);
+  if (cb->data[510] != BOOTSIG0 ||
+      cb->data[511] != BOOTSIG1) return (false);
 
-  bpb_t* bpb = &cacheBuffer.fbs.bpb;
+  bpb_t* bpb = &cb->fbs.bpb;
   fatCount = bpb->fatCount;
   blocksPerCluster = bpb->sectorsPerCluster;
   blocksPerFat = bpb->sectorsPerFat16;
@@ -219,6 +225,7 @@ FAT16::File::open(uint16_t index, uint8_t oflag)
   m_dirEntryIndex = index;
   m_fileSize = d->fileSize;
   m_firstCluster = d->firstClusterLow;
+  m_contiguousEnd = 0;
   m_flags = oflag & (O_RDWR | O_SYNC | O_APPEND);
   if (oflag & O_TRUNC) return (truncate(0));
   return (true);
@@ -262,9 +269,11 @@ FAT16::File::read(void* buf, size_t nbyte)
     uint8_t blkOfCluster = blockOfCluster(m_curPosition);
     uint16_t blockOffset = cacheDataOffset(m_curPosition);
     if (blkOfCluster == 0 && blockOffset == 0) {
-      // Start next cluster
+      // Start next cluster; no FAT lookup within preallocated run
       if (m_curCluster == 0) {
         m_curCluster = m_firstCluster;
+      } else if (m_curCluster + 1 < m_contiguousEnd) {
+        m_curCluster += 1;
       } else {
         if (!fatGet(m_curCluster, &m_curCluster)) return (IOStream::EOF);
       }
@@ -273,11 +282,11 @@ FAT16::File::read(void* buf, size_t nbyte)
     }
 
     // Cache data block
-    if (!cacheRawBlock(dataBlockLba(m_curCluster, blkOfCluster)))
-      return (IOStream::EOF);
+    cache16_t* cb = cacheRawBlock(dataBlockLba(m_curCluster, blkOfCluster));
+    if (cb == NULL) return (IOStream::EOF);
 
     // Location of data in cache
-    uint8_t* src = cacheBuffer.data + blockOffset;
+    uint8_t* src = cb->data + blockOffset;
 
     // Max number of byte available in block
     uint16_t n = 512 - blockOffset;
@@ -312,6 +321,32 @@ FAT16::File::write(const void* buf, size_t nbyte)
   while (nToWrite > 0) {
     uint8_t blkOfCluster = blockOfCluster(m_curPosition);
     uint16_t blockOffset = cacheDataOffset(m_curPosition);
+
+    // Fast path; write whole blocks at end of file within the
+    // preallocated run directly to the device
+    if (m_contiguousEnd != 0
+	&& blockOffset == 0
+	&& nToWrite >= 512
+	&& m_curPosition >= m_fileSize) {
+      uint32_t block = m_curPosition >> 9;
+      uint32_t blocks = (uint32_t) (m_contiguousEnd - m_firstCluster)
+	* blocksPerCluster;
+      if (block < blocks) {
+	uint16_t count = nToWrite >> 9;
+	if (count > blocks - block) count = blocks - block;
+	uint32_t lba = dataBlockLba(m_firstCluster, 0) + block;
+	uint16_t n = count << 9;
+	cacheDiscard(lba, count);
+	if (!writeBlocks(lba, src, count)) return (IOStream::EOF);
+	m_curPosition += n;
+	m_curCluster = m_firstCluster
+	  + ((m_curPosition - 1) >> 9) / blocksPerCluster;
+	nToWrite -= n;
+	src += n;
+	continue;
+      }
+    }
+
     if (blkOfCluster == 0 && blockOffset == 0) {
       // Start of new cluster
       if (m_curCluster == 0) {
@@ -321,6 +356,9 @@ FAT16::File::write(const void* buf, size_t nbyte)
         } else {
           m_curCluster = m_firstCluster;
         }
+      } else if (m_curCluster + 1 < m_contiguousEnd) {
+	// Next cluster in preallocated run; no FAT lookup
+	m_curCluster += 1;
       } else {
         fat_t next;
         if (!fatGet(m_curCluster, &next)) return (IOStream::EOF);
@@ -333,16 +371,13 @@ FAT16::File::write(const void* buf, size_t nbyte)
       }
     }
     uint32_t lba = dataBlockLba(m_curCluster, blkOfCluster);
-    if (blockOffset == 0 && m_curPosition >= m_fileSize) {
-      // Start of new block don't need to read into cache
-      if (!cacheFlush()) return (IOStream::EOF);
-      cacheBlockNumber = lba;
-      cacheSetDirty();
-    } else {
-      // Rewrite part of block
-      if (!cacheRawBlock(lba, CACHE_FOR_WRITE)) return (IOStream::EOF);
-    }
-    uint8_t* dst = cacheBuffer.data + blockOffset;
+    uint8_t action = CACHE_FOR_WRITE;
+    // Start of new block don't need to read into cache
+    if (blockOffset == 0 && m_curPosition >= m_fileSize)
+      action |= CACHE_NO_READ;
+    cache16_t* cb = cacheRawBlock(lba, action);
+    if (cb == NULL) return (IOStream::EOF);
+    uint8_t* dst = cb->data + blockOffset;
 
     // Max space in block
     uint16_t n = 512 - blockOffset;
@@ -395,6 +430,12 @@ FAT16::File::seek(uint32_t pos, uint8_t whence)
     return (true);
   }
   fat_t n = ((pos - 1) >> 9) / blocksPerCluster;
+  if (m_firstCluster + n < m_contiguousEnd) {
+    // Within preallocated run; no need to follow chain
+    m_curCluster = m_firstCluster + n;
+    m_curPosition = pos;
+    return (true);
+  }
   if (pos < m_curPosition || m_curPosition == 0) {
     // Must follow chain from first cluster
     m_curCluster = m_firstCluster;
@@ -417,9 +458,10 @@ FAT16::File::truncate(uint32_t length)
 
   if (length > m_fileSize) return (false);
 
-  // Filesize and length are zero - nothing to do
-  if (m_fileSize == 0) return (true);
+  // No clusters allocated - nothing to do
+  if (m_firstCluster == 0) return (true);
   uint32_t newPos = m_curPosition > length ? length : m_curPosition;
+  m_contiguousEnd = 0;
   if (length == 0) {
     // Free all clusters
     if (!freeChain(m_firstCluster)) return (false);
@@ -441,6 +483,49 @@ FAT16::File::truncate(uint32_t length)
   return seek(newPos);
 }
 
+bool
+FAT16::File::preallocate(uint32_t size)
+{
+  // Error if file is not open for write or not empty
+  if (!(m_flags & O_WRITE)) return (false);
+  if (m_firstCluster != 0 || size == 0) return (false);
+
+  // Number of clusters needed
+  uint32_t bytesPerCluster = ((uint32_t) blocksPerCluster) << 9;
+  uint32_t clusters = (size + bytesPerCluster - 1) / bytesPerCluster;
+  if (clusters > clusterCount) return (false);
+  fat_t count = clusters;
+
+  // Search for first free run of clusters
+  fat_t start = 0;
+  fat_t length = 0;
+  for (fat_t cluster = 2; cluster <= clusterCount + 1; cluster++) {
+    fat_t value;
+    if (!fatGet(cluster, &value)) return (false);
+    if (value != 0) {
+      length = 0;
+      continue;
+    }
+    if (length == 0) start = cluster;
+    if (++length == count) break;
+  }
+  if (length != count) return (false);
+
+  // Link the run and mark end of chain
+  fat_t last = start + count - 1;
+  for (fat_t cluster = start; cluster < last; cluster++)
+    if (!fatPut(cluster, cluster + 1)) return (false);
+  if (!fatPut(last, EOC16)) return (false);
+
+  // Update directory entry with first cluster
+  m_firstCluster = start;
+  m_contiguousEnd = start + count;
+  m_curCluster = 0;
+  m_curPosition = 0;
+  m_flags |= F_FILE_DIR_DIRTY;
+  return (sync());
+}
+
 bool
 FAT16::File::dirEntry(FAT16::dir_t* dir)
 {
@@ -561,49 +646,142 @@ FAT16::dir_t*
 FAT16::cacheDirEntry(uint16_t index, uint8_t action)
 {
   if (index >= rootDirEntryCount) return NULL;
-  if (!cacheRawBlock(rootDirStartBlock + (index >> 4), action)) return NULL;
-  return &cacheBuffer.dir[index & 0XF];
+  cache16_t* cb = cacheRawBlock(rootDirStartBlock + (index >> 4), action);
+  if (cb == NULL) return NULL;
+  return &cb->dir[index & 0XF];
+}
+
+bool
+FAT16::cacheWrite(cache_t* entry)
+{
+  // Write block and update mirror blocks if FAT block
+  uint32_t lba = entry->blockNumber;
+  uint8_t count = (cacheRank(lba) == 2) ? fatCount : 1;
+  while (count--) {
+    if (!device->write(lba, entry->buffer.data)) return (false);
+    cacheStat.writes += 1;
+    lba += blocksPerFat;
+  }
+  entry->dirty = 0;
+  return (true);
 }
 
-uint8_t
+bool
 FAT16::cacheFlush(void)
 {
-  if (cacheDirty) {
-    if (!device->write(cacheBlockNumber, cacheBuffer.data)) {
-      return (false);
+  // Write all modified blocks
+  for (uint8_t i = 0; i < CACHE_MAX; i++) {
+    cache_t* entry = &cache[i];
+    if (entry->dirty && !cacheWrite(entry)) return (false);
+  }
+  return (true);
+}
+
+void
+FAT16::cacheDiscard(uint32_t blockNumber, uint16_t count)
+{
+  for (uint8_t i = 0; i < CACHE_MAX; i++) {
+    cache_t* entry = &cache[i];
+    if (entry->blockNumber - blockNumber < count) {
+      entry->blockNumber = CACHE_INVALID;
+      entry->dirty = 0;
     }
-    if (cacheMirrorBlock) {
-      if (!device->write(cacheMirrorBlock, cacheBuffer.data)) {
-        return (false);
-      }
-      cacheMirrorBlock = 0;
+  }
+}
+
+bool
+FAT16::writeBlocks(uint32_t blockNumber, const uint8_t* src, uint16_t count)
+{
+  // Single block write
+  if (count == 1) {
+    if (!device->write(blockNumber, src)) return (false);
+    cacheStat.writes += 1;
+    return (true);
+  }
+
+  // Multiple block write with pre-erase
+  if (!device->begin_write(blockNumber, count)) return (false);
+  while (count--) {
+    if (!device->write_next(src)) {
+      device->end_write();
+      return (false);
     }
-    cacheDirty = 0;
+    cacheStat.writes += 1;
+    src += 512;
   }
-  return (true);
+  return (device->end_write());
 }
 
-uint8_t
+void
+FAT16::cacheInvalidate(void)
+{
+  for (uint8_t i = 0; i < CACHE_MAX; i++) {
+    cache[i].blockNumber = CACHE_INVALID;
+    cache[i].dirty = 0;
+  }
+  memset(&cacheStat, 0, sizeof(cacheStat));
+}
+
+FAT16::cache16_t*
 FAT16::cacheRawBlock(uint32_t blockNumber, uint8_t action)
 {
-  if (cacheBlockNumber != blockNumber) {
-    if (!cacheFlush()) return (false);
-    if (!device->read(blockNumber, cacheBuffer.data)) return (false);
-    cacheBlockNumber = blockNumber;
+  cache_t* entry = &cache[cacheLast];
+
+  // Check the latest accessed entry and then search the cache
+  if (entry->blockNumber != blockNumber) {
+    uint8_t victim = 0;
+    uint8_t rank = 0XFF;
+    uint16_t age = 0;
+    uint8_t i;
+    for (i = 0; i < CACHE_MAX; i++) {
+      entry = &cache[i];
+      if (entry->blockNumber == blockNumber) break;
+      // Select replacement; free entry or least recently used with
+      // lowest rank (data before directory and FAT blocks)
+      if (rank == 0 && age == 0XFFFF) continue;
+      uint8_t r = 0;
+      uint16_t a = 0XFFFF;
+      if (entry->blockNumber != CACHE_INVALID) {
+	r = cacheRank(entry->blockNumber);
+	a = cacheClock - entry->lastUsed;
+      }
+      if (r < rank || (r == rank && a > age)) {
+	victim = i;
+	rank = r;
+	age = a;
+      }
+    }
+
+    // Replace the selected entry on cache miss
+    if (i == CACHE_MAX) {
+      i = victim;
+      entry = &cache[i];
+      if (entry->dirty && !cacheWrite(entry)) return (NULL);
+      entry->blockNumber = CACHE_INVALID;
+      if ((action & CACHE_NO_READ) == 0) {
+	if (!device->read(blockNumber, entry->buffer.data)) return (NULL);
+	cacheStat.misses += 1;
+      }
+      entry->blockNumber = blockNumber;
+    }
+    else cacheStat.hits += 1;
+    cacheLast = i;
   }
-  cacheDirty |= action;
-  return (true);
+  else cacheStat.hits += 1;
+
+  // Mark as recently used and possibly modified
+  entry->lastUsed = ++cacheClock;
+  entry->dirty |= (action & CACHE_FOR_WRITE);
+  return (&entry->buffer);
 }
 
 bool
 FAT16::fatGet(fat_t cluster, fat_t* value)
 {
   if (cluster > (clusterCount + 1)) return (false);
-  uint32_t lba = fatStartBlock + (cluster >> 8);
-  if (lba != cacheBlockNumber) {
-    if (!cacheRawBlock(lba)) return (false);
-  }
-  *value = cacheBuffer.fat[cluster & 0XFF];
+  cache16_t* cb = cacheRawBlock(fatStartBlock + (cluster >> 8));
+  if (cb == NULL) return (false);
+  *value = cb->fat[cluster & 0XFF];
   return (true);
 }
 
@@ -613,12 +791,9 @@ FAT16::fatPut(fat_t cluster, fat_t value)
   if (cluster < 2) return (false);
   if (cluster > (clusterCount + 1)) return (false);
   uint32_t lba = fatStartBlock + (cluster >> 8);
-  if (lba != cacheBlockNumber) {
-    if (!cacheRawBlock(lba)) return (false);
-  }
-  cacheBuffer.fat[cluster & 0XFF] = value;
-  cacheSetDirty();
-  if (fatCount > 1) cacheMirrorBlock = lba + blocksPerFat;
+  cache16_t* cb = cacheRawBlock(lba, CACHE_FOR_WRITE);
+  if (cb == NULL) return (false);
+  cb->fat[cluster & 0XFF] = value;
   return (true);
 }
 
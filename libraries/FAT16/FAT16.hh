@@ -27,6 +27,16 @@
 #include "Cosa/IOStream.hh"
 #include "Cosa/FS.hh"
 
+// Default number of blocks in the block cache; one block unless at
+// least 4 Kbyte SRAM (each block is 519 bytes)
+#ifndef COSA_FAT16_CACHE_MAX
+# if (RAMEND < 0x10FF)
+#   define COSA_FAT16_CACHE_MAX 1
+# else
+#   define COSA_FAT16_CACHE_MAX 4
+# endif
+#endif
+
 /*
  * FAT16 file structures on SD card. Note: may only access files on the
  * root directory.
@@ -653,6 +663,22 @@ public:
      */
     bool truncate(uint32_t size);
 
+    /**
+     * Preallocate a contiguous run of clusters for the given number
+     * of bytes. The file must be open for write and empty. Writing
+     * and reading within the run will not require FAT lookup or
+     * update, and whole blocks are written directly to the storage
+     * device with multiple block transfer. The clusters remain
+     * allocated to the file when closed. Use truncate() to release
+     * the clusters beyond the end of file.
+     * @param[in] size number of bytes to preallocate.
+     * @return bool, true if successful otherwise false for
+     * failure. Reasons for failure include file is not open for
+     * write, file is not empty, no contiguous free run of clusters
+     * of the requested size or an I/O error occurs.
+     */
+    bool preallocate(uint32_t size);
+
     /**
      * @override{IOStream::Device}
      * Write character to the file.
@@ -699,6 +725,7 @@ public:
     uint32_t m_fileSize;      // fileSize
     fat_t m_curCluster;       // current cluster
     uint32_t m_curPosition;   // current byte offset
+    fat_t m_contiguousEnd;    // end of preallocated run from first cluster
 
     static uint8_t isEOC(fat_t cluster) { return cluster >= 0XFFF8; }
     bool addCluster();
@@ -707,6 +734,15 @@ public:
     bool dirEntry(dir_t* dir);
   };
 
+  /**
+   * Block cache statistics.
+   */
+  struct cache_stat_t {
+    uint32_t hits;		//!< Number of block requests found in cache.
+    uint32_t misses;		//!< Number of blocks read from device.
+    uint32_t writes;		//!< Number of blocks written to device.
+  };
+
   /**
    * The directory list function output selectors.
    */
@@ -771,6 +807,26 @@ public:
     return file.remove();
   }
 
+  /**
+   * Return block cache statistics. The number of hits, misses and
+   * block writes since the volume was initialized.
+   * @return statistics.
+   */
+  static const cache_stat_t& cache_stat()
+  {
+    return (cacheStat);
+  }
+
+  /**
+   * Write all modified blocks in the cache, and update the FAT
+   * mirror blocks, to the storage device.
+   * @return bool, true if successful otherwise false for failure.
+   */
+  static bool sync()
+  {
+    return (cacheFlush());
+  }
+
 protected:
   // SD device (Fix: Should be an IOBlock::Device)
   static SD *device;
@@ -786,13 +842,24 @@ protected:
   static uint32_t rootDirStartBlock;	// start of root dir
   static uint32_t dataStartBlock;	// start of data clusters
 
-  // block cache
+  // block cache; least recently used write-back with FAT blocks
+  // pinned. Modified FAT blocks and mirrors are written on eviction
+  // or flush (sync)
+  static uint8_t const CACHE_MAX = COSA_FAT16_CACHE_MAX;
   static uint8_t const CACHE_FOR_READ  = 0;    // cache a block for read
   static uint8_t const CACHE_FOR_WRITE = 1;    // cache a block and set dirty
-  static cache16_t cacheBuffer;		// 512 byte cache for raw blocks
-  static uint32_t cacheBlockNumber; 	// Logical number of block in the cache
-  static uint8_t cacheDirty;         	// cacheFlush() will write block if true
-  static uint32_t cacheMirrorBlock;  	// mirror block for second FAT
+  static uint8_t const CACHE_NO_READ = 2;      // block will be overwritten
+  static uint32_t const CACHE_INVALID = 0XFFFFFFFF; // no block in entry
+  struct cache_t {
+    uint32_t blockNumber;		// Logical number of block in entry
+    uint16_t lastUsed;			// Cache clock at latest access
+    uint8_t dirty;			// cacheFlush() will write block if true
+    cache16_t buffer;			// 512 byte cache for raw block
+  };
+  static cache_t cache[CACHE_MAX];	// cache entries
+  static uint8_t cacheLast;		// index of latest accessed entry
+  static uint16_t cacheClock;		// access counter for LRU
+  static cache_stat_t cacheStat;	// cache statistics
 
   // callback function for date/time
   static void (*dateTime)(uint16_t* date, uint16_t* time);
@@ -812,11 +879,18 @@ protected:
     return position & 0X1FF;
   }
   static dir_t* cacheDirEntry(uint16_t index, uint8_t action = 0);
-  static uint8_t cacheRawBlock(uint32_t blockNumber, uint8_t action = 0);
-  static uint8_t cacheFlush(void);
-  static void cacheSetDirty(void)
+  static cache16_t* cacheRawBlock(uint32_t blockNumber, uint8_t action = 0);
+  static bool cacheWrite(cache_t* entry);
+  static void cacheDiscard(uint32_t blockNumber, uint16_t count);
+  static bool cacheFlush(void);
+  static void cacheInvalidate(void);
+  static uint8_t cacheRank(uint32_t blockNumber)
   {
-    cacheDirty |= CACHE_FOR_WRITE;
+    // Eviction rank; data blocks first, then directory and FAT blocks
+    if (blockNumber >= dataStartBlock) return (0);
+    if (blockNumber >= rootDirStartBlock) return (1);
+    if (blockNumber >= fatStartBlock) return (2);
+    return (0);
   }
   static uint32_t dataBlockLba(fat_t cluster, uint8_t blockOfCluster)
   {
@@ -825,6 +899,9 @@ protected:
 	    blockOfCluster);
   }
 
+  static bool writeBlocks(uint32_t blockNumber, const uint8_t* src,
+			  uint16_t count);
+
   static bool fatGet(fat_t cluster, fat_t* value);
   static bool fatPut(fat_t cluster, fat_t value);
 
@@ -138,6 +138,10 @@ void loop()
 
   // Open log file and write header (text format)
   ASSERT(file.open("LOG.CSV", O_TRUNC | O_WRITE | O_CREAT));
+#if defined(USE_BINARY_FORMAT)
+  // Preallocate contiguous clusters for the log entries
+  ASSERT(file.preallocate(SAMPLES * (uint32_t) sizeof(entry)));
+#endif
 #if defined(USE_TEXT_FORMAT)
   cout << PSTR("Timestamp") << CSV << PSTR("ms");
   for (uint8_t i = 0; i < SAMPLE_MAX; i++)
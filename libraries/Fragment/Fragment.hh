@@ -0,0 +1,452 @@
+/**
+ * @file Fragment.hh
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#ifndef COSA_FRAGMENT_HH
+#define COSA_FRAGMENT_HH
+
+#include "Cosa/Types.h"
+#include "Cosa/Wireless.hh"
+#include "Cosa/RTT.hh"
+
+/**
+ * Fragmentation and reassembly layer for Wireless device drivers.
+ * Messages larger than the device payload are sent as a burst of
+ * sequence numbered fragments and reassembled by the receiver. The
+ * layer is a Wireless::Driver and is used in place of the device
+ * driver. All nodes on the network must use the layer.
+ *
+ * Each fragment carries a two byte header; the message sequence
+ * number and the fragment index with a last fragment flag. Fragments
+ * may be received out of order. A reassembly buffer is allocated per
+ * source device; SOURCE_MAX sources may send concurrently. Partial
+ * messages are discarded when a new message is received from the
+ * source or on timeout.
+ *
+ * @param[in] MSG_MAX max message size (max 32 fragments).
+ * @param[in] SOURCE_MAX number of reassembly buffers.
+ *
+ * @section Usage
+ * @code
+ * NRF24L01P nrf(NETWORK, DEVICE);
+ * Fragment<240> rf(&nrf, NRF24L01P::PAYLOAD_MAX);
+ * ...
+ * rf.send(dest, port, buf, sizeof(buf));
+ * ...
+ * int res = rf.recv(src, port, buf, sizeof(buf));
+ * @endcode
+ */
+template<uint16_t MSG_MAX = 128, uint8_t SOURCE_MAX = 2>
+class Fragment : public Wireless::Driver {
+public:
+  /** Max size of device payload (frame). */
+  static const uint8_t FRAME_MAX = 64;
+
+  /** Max number of fragments per message. */
+  static const uint8_t FRAGMENT_MAX = 32;
+
+  /** Default reassembly timeout (ms). */
+  static const uint16_t DEFAULT_TIMEOUT = 500;
+
+  /**
+   * Construct fragmentation layer on given device driver with given
+   * device payload size. The payload size must be the same on all
+   * nodes.
+   * @param[in] dev device driver.
+   * @param[in] payload max device payload size.
+   * @param[in] ms reassembly timeout (Default 500 ms).
+   */
+  Fragment(Wireless::Driver* dev, uint8_t payload,
+	   uint16_t ms = DEFAULT_TIMEOUT) :
+    Wireless::Driver(dev->network_address(), dev->device_address()),
+    m_dev(dev),
+    m_data_max((payload > FRAME_MAX ? FRAME_MAX : payload) - HEADER_MAX),
+    m_timeout(ms),
+    m_seq(0),
+    m_dropped(0)
+  {
+    static_assert(SOURCE_MAX > 0, "SOURCE_MAX should be greater than 0");
+    memset(m_source, 0, sizeof(m_source));
+  }
+
+  /**
+   * Return number of partial messages that have been discarded.
+   * @return count.
+   */
+  uint16_t dropped() const
+  {
+    return (m_dropped);
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Start the device driver.
+   * @param[in] config configuration vector (default NULL).
+   * @return bool.
+   */
+  virtual bool begin(const void* config = NULL)
+  {
+    m_dev->channel(m_channel);
+    m_dev->address(m_addr.network, m_addr.device);
+    return (m_dev->begin(config));
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Shut down the device driver.
+   * @return bool.
+   */
+  virtual bool end()
+  {
+    return (m_dev->end());
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Set device in power up mode.
+   */
+  virtual void powerup()
+  {
+    m_dev->powerup();
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Set device in power down mode.
+   */
+  virtual void powerdown()
+  {
+    m_dev->powerdown();
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Set device in wakeup on radio mode.
+   */
+  virtual void wakeup_on_radio()
+  {
+    m_dev->wakeup_on_radio();
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Return true(1) if a fragment is available otherwise false(0).
+   * @return bool.
+   */
+  virtual bool available()
+  {
+    return (m_dev->available());
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Return true(1) if there is room to send on the device
+   * otherwise false(0).
+   * @return bool.
+   */
+  virtual bool room()
+  {
+    return (m_dev->room());
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Send message in given null terminated io vector. The message is
+   * sent as a burst of fragments. Returns number of bytes sent if
+   * successful otherwise a negative error code.
+   * @param[in] dest destination network address.
+   * @param[in] port device port (or message type).
+   * @param[in] vec null terminated io vector.
+   * @return number of bytes send or negative error code.
+   */
+  virtual int send(uint8_t dest, uint8_t port, const iovec_t* vec);
+
+  /**
+   * @override{Wireless::Driver}
+   * Send message in given buffer, with given number of bytes.
+   * Returns number of bytes sent if successful otherwise a negative
+   * error code.
+   * @param[in] dest destination network address.
+   * @param[in] port device port (or message type).
+   * @param[in] buf buffer to transmit.
+   * @param[in] len number of bytes in buffer.
+   * @return number of bytes send or negative error code.
+   */
+  virtual int send(uint8_t dest, uint8_t port, const void* buf, size_t len)
+  {
+    iovec_t vec[2];
+    iovec_t* vp = vec;
+    iovec_arg(vp, buf, len);
+    iovec_end(vp);
+    return (send(dest, port, vec));
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Receive message and store into given buffer with given maximum
+   * length. Fragments are received until a message is complete or
+   * timeout. The source network address is returned in the parameter
+   * src. Returns the number of received bytes or a negative error
+   * code.
+   * @param[out] src source network address.
+   * @param[out] port device port (or message type).
+   * @param[in] buf buffer to store incoming message.
+   * @param[in] len maximum number of bytes to receive.
+   * @param[in] ms maximum time out period.
+   * @return number of bytes received or negative error code.
+   */
+  virtual int recv(uint8_t& src, uint8_t& port,
+		   void* buf, size_t len,
+		   uint32_t ms = 0L);
+
+  /**
+   * @override{Wireless::Driver}
+   * Return true(1) if the latest received message was a broadcast
+   * otherwise false(0).
+   */
+  virtual bool is_broadcast()
+  {
+    return (m_dev->is_broadcast());
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Set output power level in dBm.
+   * @param[in] dBm.
+   */
+  virtual void output_power_level(int8_t dBm)
+  {
+    m_dev->output_power_level(dBm);
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Return estimated input power level (dBm).
+   * @return power level in dBm.
+   */
+  virtual int input_power_level()
+  {
+    return (m_dev->input_power_level());
+  }
+
+  /**
+   * @override{Wireless::Driver}
+   * Return link quality indicator.
+   * @return quality indicator.
+   */
+  virtual int link_quality_indicator()
+  {
+    return (m_dev->link_quality_indicator());
+  }
+
+protected:
+  /** Fragment header. */
+  struct header_t {
+    uint8_t seq;		//!< Message sequence number.
+    uint8_t index;		//!< Fragment index and last flag.
+  };
+
+  /** Size of fragment header. */
+  static const uint8_t HEADER_MAX = sizeof(header_t);
+
+  /** Last fragment flag and fragment index mask. */
+  static const uint8_t LAST = 0x80;
+  static const uint8_t INDEX_MASK = FRAGMENT_MAX - 1;
+
+  /** Reassembly buffer per source. */
+  struct source_t {
+    uint32_t received;		//!< Received fragments; zero if free.
+    uint32_t start;		//!< Time of first fragment (ms).
+    uint16_t length;		//!< Message length when last received.
+    uint8_t src;		//!< Source device address.
+    uint8_t port;		//!< Message port.
+    uint8_t seq;		//!< Message sequence number.
+    uint8_t last;		//!< Last fragment index or FRAGMENT_MAX.
+    uint8_t buffer[MSG_MAX];	//!< Message buffer.
+  };
+
+  /** Device driver. */
+  Wireless::Driver* m_dev;
+
+  /** Max fragment data size. */
+  uint8_t m_data_max;
+
+  /** Reassembly timeout (ms). */
+  uint16_t m_timeout;
+
+  /** Next message sequence number. */
+  uint8_t m_seq;
+
+  /** Number of discarded partial messages. */
+  uint16_t m_dropped;
+
+  /** Reassembly buffers. */
+  source_t m_source[SOURCE_MAX];
+
+  /**
+   * Lookup reassembly buffer for given source and message. Restart
+   * the buffer if a new message. Allocate a free, expired or the
+   * oldest buffer if the source is not found.
+   * @param[in] src source device address.
+   * @param[in] port message port.
+   * @param[in] seq message sequence number.
+   * @return reassembly buffer.
+   */
+  source_t* lookup(uint8_t src, uint8_t port, uint8_t seq);
+};
+
+template<uint16_t MSG_MAX, uint8_t SOURCE_MAX>
+int
+Fragment<MSG_MAX,SOURCE_MAX>::send(uint8_t dest, uint8_t port,
+				   const iovec_t* vec)
+{
+  // Sanity check the message size
+  if (UNLIKELY(vec == NULL)) return (EINVAL);
+  size_t len = iovec_size(vec);
+  if (UNLIKELY(len > MSG_MAX)) return (EMSGSIZE);
+  if (UNLIKELY(len > (size_t) m_data_max * FRAGMENT_MAX)) return (EMSGSIZE);
+
+  // Send fragments as a burst; gather payload from the io vector
+  uint8_t frame[FRAME_MAX];
+  header_t* header = (header_t*) frame;
+  const uint8_t* bp = (const uint8_t*) vec->buf;
+  size_t size = vec->size;
+  size_t left = len;
+  uint8_t index = 0;
+  header->seq = m_seq++;
+  do {
+    uint8_t count = (left > m_data_max ? m_data_max : left);
+    left -= count;
+    header->index = index++ | (left == 0 ? LAST : 0);
+    uint8_t* dp = frame + HEADER_MAX;
+    for (uint8_t n = count; n != 0;) {
+      while (size == 0) {
+	vec += 1;
+	bp = (const uint8_t*) vec->buf;
+	size = vec->size;
+      }
+      uint8_t m = (size > n ? n : size);
+      memcpy(dp, bp, m);
+      dp += m;
+      bp += m;
+      size -= m;
+      n -= m;
+    }
+    int res = m_dev->send(dest, port, frame, HEADER_MAX + count);
+    if (UNLIKELY(res < 0)) return (res);
+  } while (left != 0);
+  return (len);
+}
+
+template<uint16_t MSG_MAX, uint8_t SOURCE_MAX>
+int
+Fragment<MSG_MAX,SOURCE_MAX>::recv(uint8_t& src, uint8_t& port,
+				   void* buf, size_t len,
+				   uint32_t ms)
+{
+  uint8_t frame[FRAME_MAX];
+  header_t* header = (header_t*) frame;
+  uint32_t start = RTT::millis();
+  while (1) {
+    // Receive next fragment within the remaining time period
+    uint32_t timeout = 0L;
+    if (ms != 0) {
+      uint32_t elapsed = RTT::since(start);
+      if (elapsed >= ms) return (ETIME);
+      timeout = ms - elapsed;
+    }
+    int res = m_dev->recv(src, port, frame, sizeof(frame), timeout);
+    if (UNLIKELY(res < 0)) return (res);
+    if (UNLIKELY(res < HEADER_MAX)) continue;
+    uint8_t count = res - HEADER_MAX;
+    uint8_t index = header->index & INDEX_MASK;
+
+    // Check for unfragmented message; direct copy
+    if (header->index == LAST) {
+      if (UNLIKELY(count > len)) return (EMSGSIZE);
+      memcpy(buf, frame + HEADER_MAX, count);
+      return (count);
+    }
+
+    // Store fragment in reassembly buffer
+    source_t* source = lookup(src, port, header->seq);
+    uint16_t offset = index * m_data_max;
+    if (UNLIKELY(offset + count > MSG_MAX)) {
+      source->received = 0;
+      m_dropped += 1;
+      continue;
+    }
+    memcpy(source->buffer + offset, frame + HEADER_MAX, count);
+    source->received |= (1UL << index);
+    if (header->index & LAST) {
+      source->last = index;
+      source->length = offset + count;
+    }
+
+    // Check if all fragments have been received
+    if (source->last == FRAGMENT_MAX) continue;
+    uint32_t all = (source->last == FRAGMENT_MAX - 1) ?
+      0xffffffffUL :
+      (1UL << (source->last + 1)) - 1;
+    if (source->received != all) continue;
+    source->received = 0;
+    if (UNLIKELY(source->length > len)) return (EMSGSIZE);
+    memcpy(buf, source->buffer, source->length);
+    return (source->length);
+  }
+}
+
+template<uint16_t MSG_MAX, uint8_t SOURCE_MAX>
+typename Fragment<MSG_MAX,SOURCE_MAX>::source_t*
+Fragment<MSG_MAX,SOURCE_MAX>::lookup(uint8_t src, uint8_t port, uint8_t seq)
+{
+  // Search for source buffer, free or expired buffer, and oldest
+  source_t* found = NULL;
+  source_t* oldest = m_source;
+  for (uint8_t i = 0; i < SOURCE_MAX; i++) {
+    source_t* source = &m_source[i];
+    if (source->received != 0) {
+      if (source->src == src) {
+	if (source->seq == seq && source->port == port
+	    && RTT::since(source->start) < m_timeout)
+	  return (source);
+	found = source;
+	break;
+      }
+      if (RTT::since(source->start) < m_timeout) {
+	if ((int32_t) (source->start - oldest->start) < 0) oldest = source;
+	continue;
+      }
+    }
+    if (found == NULL) found = source;
+  }
+
+  // Discard partial message if buffer is reused
+  if (found == NULL) found = oldest;
+  if (found->received != 0) m_dropped += 1;
+  found->received = 0;
+  found->start = RTT::millis();
+  found->length = 0;
+  found->src = src;
+  found->port = port;
+  found->seq = seq;
+  found->last = FRAGMENT_MAX;
+  return (found);
+}
+#endif
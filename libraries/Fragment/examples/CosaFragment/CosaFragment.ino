@@ -0,0 +1,119 @@
+/**
+ * @file CosaFragment.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Cosa Wireless fragmentation demo; send large messages from the
+ * sender node to the receiver node and print the throughput. Build
+ * one node with SENDER defined.
+ *
+ * @section Circuit
+ * See Wireless drivers for circuit connections.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include <Fragment.h>
+
+#include "Cosa/RTT.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/UART.hh"
+#include "Cosa/Watchdog.hh"
+
+// Configuration; network and device addresses
+#define NETWORK 0xC05A
+#define SENDER
+#if defined(SENDER)
+#define DEVICE 0x10
+#else
+#define DEVICE 0x01
+#endif
+#define DEST 0x01
+
+// Select Wireless device driver
+// #include <CC1101.h>
+// CC1101 dev(NETWORK, DEVICE);
+// #define PAYLOAD_MAX CC1101::PAYLOAD_MAX
+
+#include <NRF24L01P.h>
+NRF24L01P dev(NETWORK, DEVICE);
+#define PAYLOAD_MAX NRF24L01P::PAYLOAD_MAX
+
+// #include <RFM69.h>
+// RFM69 dev(NETWORK, DEVICE);
+// #define PAYLOAD_MAX RFM69::PAYLOAD_MAX
+
+// Fragmentation layer with message size and one reassembly buffer
+#define MSG_MAX 240
+Fragment<MSG_MAX, 1> rf(&dev, PAYLOAD_MAX);
+
+// Message port and number of messages per measurement
+static const uint8_t PORT = 0x20;
+static const uint8_t COUNT = 20;
+
+uint8_t msg[MSG_MAX];
+
+void setup()
+{
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaFragment: started"));
+  Watchdog::begin();
+  RTT::begin();
+  ASSERT(rf.begin());
+  TRACE(sizeof(rf));
+}
+
+#if defined(SENDER)
+void loop()
+{
+  static uint8_t nr = 0;
+  uint32_t start = RTT::millis();
+  for (uint8_t i = 0; i < COUNT; i++) {
+    for (uint16_t j = 0; j < sizeof(msg); j++) msg[j] = nr + j;
+    int res = rf.send(DEST, PORT, msg, sizeof(msg));
+    if (res != sizeof(msg)) trace << PSTR("send:error=") << res << endl;
+    nr += 1;
+  }
+  uint32_t ms = RTT::since(start);
+  trace << PSTR("send:") << (COUNT * sizeof(msg) * 1000L) / ms
+	<< PSTR(" byte/s") << endl;
+  sleep(1);
+}
+#else
+void loop()
+{
+  uint8_t src;
+  uint8_t port;
+  uint16_t bytes = 0;
+  uint32_t start = RTT::millis();
+  for (uint8_t i = 0; i < COUNT; i++) {
+    int res = rf.recv(src, port, msg, sizeof(msg), 1000);
+    if (res < 0) {
+      trace << PSTR("recv:error=") << res << endl;
+      return;
+    }
+    for (int j = 1; j < res; j++)
+      if (msg[j] != (uint8_t) (msg[0] + j)) {
+	trace << PSTR("recv:corrupt:src=") << hex << src << endl;
+	break;
+      }
+    bytes += res;
+  }
+  uint32_t ms = RTT::since(start);
+  trace << PSTR("recv:") << (bytes * 1000L) / ms
+	<< PSTR(" byte/s, dropped=") << rf.dropped() << endl;
+}
+#endif
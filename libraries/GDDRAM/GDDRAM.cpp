@@ -19,6 +19,7 @@
  */
 
 #include "GDDRAM.hh"
+#include "Font.hh"
 
 GDDRAM::GDDRAM(uint16_t width,
 	       uint16_t height,
@@ -107,18 +108,48 @@ GDDRAM::draw_image(uint16_t x, uint16_t y, Image* image)
       write(RAMWR);
     spi.end();
   spi.release();
-  for (uint16_t i = 0; i < height; i++) {
-    color16_t buf[Image::BUFFER_MAX];
-    size_t count;
-    for (uint16_t j = 0; j < width; j += count) {
-      count = (width - j > Image::BUFFER_MAX) ? Image::BUFFER_MAX : width - j;
-      image->read(buf, count);
-      spi.acquire(this);
-        spi.begin();
-	for (uint16_t k = 0; k < count; k++) write(buf[k]);
-	spi.end();
-      spi.release();
+
+  // Uncompressed images are read and written in buffers
+  if (!image->is_compressed()) {
+    for (uint16_t i = 0; i < height; i++) {
+      color16_t buf[Image::BUFFER_MAX];
+      size_t count;
+      for (uint16_t j = 0; j < width; j += count) {
+	count = (width - j > Image::BUFFER_MAX) ? Image::BUFFER_MAX : width - j;
+	if (UNLIKELY(!image->read(buf, count))) return;
+	spi.acquire(this);
+	  spi.begin();
+	    for (uint16_t k = 0; k < count; k++) write(buf[k].rgb);
+	  spi.end();
+	spi.release();
+      }
     }
+    return;
+  }
+
+  // Runs may span rows as the window address wraps. Decode a batch of
+  // runs before acquiring the bus; the image source may share it
+  uint32_t pixels = ((uint32_t) width) * height;
+  while (pixels != 0) {
+    color16_t color[Image::BUFFER_MAX];
+    uint16_t length[Image::BUFFER_MAX];
+    uint8_t runs = 0;
+    do {
+      uint16_t max = (pixels > 0xffffUL) ? 0xffff : pixels;
+      size_t count = image->read_run(color[runs], max);
+      if (UNLIKELY(count == 0)) {
+	pixels = 0;
+	break;
+      }
+      length[runs++] = count;
+      pixels -= count;
+    } while ((pixels != 0) && (runs < Image::BUFFER_MAX));
+    if (runs == 0) return;
+    spi.acquire(this);
+      spi.begin();
+        for (uint8_t i = 0; i < runs; i++) write(color[i].rgb, length[i]);
+      spi.end();
+    spi.release();
   }
 }
 
@@ -191,6 +222,67 @@ GDDRAM::fill_rect(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
   spi.release();
 }
 
+void
+GDDRAM::draw_char(uint16_t x, uint16_t y, char c)
+{
+  Font* font = get_text_font();
+  uint8_t scale = get_text_scale();
+  uint16_t width = scale * (font->WIDTH + font->SPACING);
+  uint16_t height = scale * font->HEIGHT;
+
+  // Check for transparent text, clipping or too wide font
+  if (!get_text_opaque()
+      || (font->WIDTH > GLYPH_WIDTH_MAX)
+      || (x + width > WIDTH)
+      || (y + height > HEIGHT)) {
+    Canvas::draw_char(x, y, c);
+    return;
+  }
+
+  // Write character cell as text and canvas color runs; each glyph
+  // byte is a column of eight pixels and is scaled in both directions
+  const uint16_t fg = get_text_color().rgb;
+  const uint16_t bg = get_canvas_color().rgb;
+  const uint16_t spacing = scale * font->SPACING;
+  Font::Glyph glyph(font, c);
+  uint8_t column[GLYPH_WIDTH_MAX];
+  spi.acquire(this);
+    spi.begin();
+      write(CASET, x, x + width - 1);
+      write(PASET, y, y + height - 1);
+      write(RAMWR);
+      for (uint8_t i = 0; i < font->HEIGHT; i += CHARBITS) {
+	for (uint8_t j = 0; j < font->WIDTH; j++) column[j] = glyph.next();
+	uint8_t rows = font->HEIGHT - i;
+	if (rows > CHARBITS) rows = CHARBITS;
+	for (uint8_t mask = 1; rows != 0; rows--, mask <<= 1) {
+	  for (uint8_t k = 0; k < scale; k++) {
+	    bool on = (column[0] & mask) != 0;
+	    uint16_t run = scale;
+	    for (uint8_t j = 1; j < font->WIDTH; j++) {
+	      bool pixel = (column[j] & mask) != 0;
+	      if (pixel == on) {
+		run += scale;
+		continue;
+	      }
+	      write(on ? fg : bg, run);
+	      on = pixel;
+	      run = scale;
+	    }
+	    if (on) {
+	      write(fg, run);
+	      run = 0;
+	    }
+	    run += spacing;
+	    if (run != 0) write(bg, run);
+	  }
+	}
+      }
+    spi.end();
+  spi.release();
+  set_cursor(x + width, y);
+}
+
 bool
 GDDRAM::end()
 {
@@ -101,6 +101,20 @@ public:
    */
   virtual void fill_rect(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
 
+  /**
+   * @override{Canvas}
+   * Draw character with current text color, font, scale and mode.
+   * Opaque characters are written as a single address window with
+   * runs of text and canvas color in one SPI transaction. Transparent
+   * characters, characters that are clipped or fonts wider than
+   * GLYPH_WIDTH_MAX are drawn with Canvas::draw_char().
+   * @param[in] x position.
+   * @param[in] y position.
+   * @param[in] c character.
+   */
+  virtual void draw_char(uint16_t x, uint16_t y, char c);
+  using Canvas::draw_char;
+
   /**
    * @override{Canvas}
    * Stop sequence of interaction with device.
@@ -109,6 +123,9 @@ public:
   virtual bool end();
 
 protected:
+  /** Max font width for opaque character window write. */
+  static const uint8_t GLYPH_WIDTH_MAX = 32;
+
   OutputPin m_dc;		//!< Data/Command select pin.
   bool m_initiated;		//!< Initialization state.
 
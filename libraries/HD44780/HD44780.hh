@@ -24,6 +24,7 @@
 #include "Cosa/SPI.hh"
 #include "Cosa/LCD.hh"
 #include "Cosa/OutputPin.hh"
+#include "Cosa/Periodic.hh"
 
 /**
  * HD44780 (LCD-II) Dot Matix Liquid Crystal Display Controller/Driver
@@ -829,6 +830,178 @@ public:
     uint8_t m_rs;		//!< Command/Data select.
   };
 
+  /**
+   * HD44780 shadow text buffer. Text output is written to an in-memory
+   * copy of the display (DDRAM) and the caller returns immediately.
+   * The periodic job compares the buffer with a copy of the display
+   * contents and writes only changed cells; each run of changed cells
+   * is a cursor move (if needed) and a single write8n burst. Runs on
+   * the same line separated by a single unchanged cell are merged as
+   * the cell costs the same as a cursor move. Redraw time is
+   * proportional to the number of changed cells, not the display size.
+   *
+   * The display is write-only (RW is grounded by the adapters) so the
+   * busy-flag cannot be polled; the adapter per-byte execution delay
+   * is retained but only paid for changed cells.
+   *
+   * @section Usage
+   * @code
+   * HD44780::Port4b port;
+   * HD44780 lcd(&port, 20, 4);
+   * HD44780::Shadow shadow(&lcd, Watchdog::scheduler(), 64);
+   * IOStream cout(&shadow);
+   * ...
+   * shadow.begin();
+   * cout << clear << PSTR("time: ") << RTT::millis();
+   * @endcode
+   */
+  class Shadow : public LCD::Device, public Periodic {
+  public:
+    /** Max number of characters (40X2, 20X4). */
+    static const uint8_t TEXT_MAX = 80;
+
+    /**
+     * Construct shadow text buffer for given display. Changes are
+     * written to the display by the given scheduler with the given
+     * period. The display is initiated when calling begin().
+     * @param[in] lcd display.
+     * @param[in] scheduler for the periodic job.
+     * @param[in] period in scheduler time unit.
+     */
+    Shadow(HD44780* lcd, Job::Scheduler* scheduler, uint32_t period) :
+      LCD::Device(),
+      Periodic(scheduler, period),
+      m_lcd(lcd),
+      m_size(lcd->WIDTH * lcd->HEIGHT)
+    {
+      if (m_size > TEXT_MAX) m_size = TEXT_MAX;
+    }
+
+    /**
+     * @override{LCD::Device}
+     * Start display and periodic update. Returns true if successful
+     * otherwise false.
+     * @return boolean.
+     */
+    virtual bool begin();
+
+    /**
+     * @override{LCD::Device}
+     * Write pending changes, stop periodic update and display.
+     * Returns true if successful otherwise false.
+     * @return boolean.
+     */
+    virtual bool end();
+
+    /**
+     * @override{LCD::Device}
+     * Turn display backlight on.
+     */
+    virtual void backlight_on()
+    {
+      m_lcd->backlight_on();
+    }
+
+    /**
+     * @override{LCD::Device}
+     * Turn display backlight off.
+     */
+    virtual void backlight_off()
+    {
+      m_lcd->backlight_off();
+    }
+
+    /**
+     * @override{LCD::Device}
+     * Turn display on.
+     */
+    virtual void display_on()
+    {
+      m_lcd->display_on();
+    }
+
+    /**
+     * @override{LCD::Device}
+     * Turn display off.
+     */
+    virtual void display_off()
+    {
+      m_lcd->display_off();
+    }
+
+    /**
+     * @override{LCD::Device}
+     * Clear text buffer and move cursor to home(0, 0).
+     */
+    virtual void display_clear();
+
+    /**
+     * @override{LCD::Device}
+     * Set cursor position to given position.
+     * @param[in] x.
+     * @param[in] y.
+     */
+    virtual void set_cursor(uint8_t x, uint8_t y);
+
+    /**
+     * @override{IOStream::Device}
+     * Write character to text buffer. Handles carriage-return-line-
+     * feed, back-space, alert, horizontal tab and form-feed. Returns
+     * character or EOF on error.
+     * @param[in] c character to write.
+     * @return character written or EOF(-1).
+     */
+    virtual int putchar(char c);
+
+    /** Overloaded virtual member function write. */
+    using IOStream::Device::write;
+
+    /**
+     * @override{IOStream::Device}
+     * Write data from buffer with given size to text buffer.
+     * @param[in] buf buffer to write.
+     * @param[in] size number of bytes to write.
+     * @return number of bytes written or EOF(-1).
+     */
+    virtual int write(const void* buf, size_t size);
+
+    /**
+     * Return number of changed cells not yet written to the display.
+     * @return number of cells.
+     */
+    uint8_t pending() const;
+
+    /**
+     * @override{IOStream::Device}
+     * Write changed cells to the display. Called by the periodic
+     * job.
+     * @return zero(0).
+     */
+    virtual int flush();
+
+  protected:
+    HD44780* m_lcd;		//!< Display.
+    uint8_t m_size;		//!< Number of cells.
+    char m_text[TEXT_MAX];	//!< Text buffer.
+    char m_ddram[TEXT_MAX];	//!< Display contents.
+
+    /**
+     * @override{Job}
+     * Write changed cells to the display.
+     */
+    virtual void run()
+    {
+      flush();
+    }
+
+    /**
+     * Clear text buffer line from given position to end of line.
+     * @param[in] x start position.
+     * @param[in] y line.
+     */
+    void line_clear(uint8_t x, uint8_t y);
+  };
+
   /**
    * Bus Timing Characteristics (in micro-seconds), fig. 25, pp. 50.
    */
@@ -0,0 +1,194 @@
+/**
+ * @file HD44780_Shadow.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include "HD44780.hh"
+
+bool
+HD44780::Shadow::begin()
+{
+  // Display is cleared by begin; both buffers are blank
+  if (!m_lcd->begin()) return (false);
+  memset(m_text, ' ', m_size);
+  memset(m_ddram, ' ', m_size);
+  m_x = 0;
+  m_y = 0;
+  reschedule();
+  return (true);
+}
+
+bool
+HD44780::Shadow::end()
+{
+  stop();
+  flush();
+  return (m_lcd->end());
+}
+
+void
+HD44780::Shadow::display_clear()
+{
+  memset(m_text, ' ', m_size);
+  m_x = 0;
+  m_y = 0;
+}
+
+void
+HD44780::Shadow::set_cursor(uint8_t x, uint8_t y)
+{
+  if (x >= m_lcd->WIDTH) x = 0;
+  if (y >= m_lcd->HEIGHT) y = 0;
+  m_x = x;
+  m_y = y;
+}
+
+void
+HD44780::Shadow::line_clear(uint8_t x, uint8_t y)
+{
+  const uint8_t WIDTH = m_lcd->WIDTH;
+  uint8_t ix = y * WIDTH + x;
+  while ((x++ < WIDTH) && (ix < m_size)) m_text[ix++] = ' ';
+}
+
+int
+HD44780::Shadow::putchar(char c)
+{
+  const uint8_t WIDTH = m_lcd->WIDTH;
+
+  // Check for special characters
+  if (c < ' ') {
+
+    // Carriage-return: move to start of line
+    if (c == '\r') {
+      set_cursor(0, m_y);
+      return (c);
+    }
+
+    // New-line: clear line
+    if (c == '\n') {
+      set_cursor(0, m_y + 1);
+      line_clear(0, m_y);
+      return (c);
+    }
+
+    // Horizontal tab
+    if (c == '\t') {
+      uint8_t x = m_x + m_tab - (m_x % m_tab);
+      uint8_t y = m_y + (x >= WIDTH);
+      set_cursor(x, y);
+      return (c);
+    }
+
+    // Form-feed: clear the display
+    if (c == '\f') {
+      display_clear();
+      return (c);
+    }
+
+    // Back-space: move cursor back one step (if possible)
+    if (c == '\b') {
+      set_cursor(m_x - 1, m_y);
+      return (c);
+    }
+
+    // Alert: blink the backlight
+    if (c == '\a') {
+      return (m_lcd->putchar(c));
+    }
+  }
+
+  // Write character to text buffer
+  if (m_x == WIDTH) putchar('\n');
+  uint8_t ix = m_y * WIDTH + m_x;
+  if (ix < m_size) m_text[ix] = c;
+  m_x += 1;
+
+  return (c & 0xff);
+}
+
+int
+HD44780::Shadow::write(const void* buf, size_t size)
+{
+  const uint8_t WIDTH = m_lcd->WIDTH;
+  const char* bp = (const char*) buf;
+  for (size_t n = size; n != 0; n--) {
+    if (m_x == WIDTH) set_cursor(0, m_y + 1);
+    uint8_t ix = m_y * WIDTH + m_x;
+    if (ix < m_size) m_text[ix] = *bp;
+    bp += 1;
+    m_x += 1;
+  }
+  return (size);
+}
+
+uint8_t
+HD44780::Shadow::pending() const
+{
+  uint8_t res = 0;
+  for (uint8_t ix = 0; ix < m_size; ix++)
+    if (m_text[ix] != m_ddram[ix]) res += 1;
+  return (res);
+}
+
+int
+HD44780::Shadow::flush()
+{
+  const uint8_t WIDTH = m_lcd->WIDTH;
+  bool written = false;
+  uint8_t ax = 0xff;
+  uint8_t ay = 0xff;
+
+  for (uint8_t y = 0, row = 0; row < m_size; y++, row += WIDTH) {
+    uint8_t width = (m_size - row < WIDTH) ? m_size - row : WIDTH;
+    const char* text = &m_text[row];
+    char* ddram = &m_ddram[row];
+    uint8_t x = 0;
+    while (x < width) {
+      // Skip unchanged cells
+      if (text[x] == ddram[x]) {
+	x += 1;
+	continue;
+      }
+
+      // Find end of run; merge with next run if separated by one cell
+      uint8_t end = x + 1;
+      while (end < width) {
+	if (text[end] != ddram[end])
+	  end += 1;
+	else if ((end + 1 < width) && (text[end + 1] != ddram[end + 1]))
+	  end += 2;
+	else break;
+      }
+
+      // Move cursor unless the address counter is already in position
+      uint8_t count = end - x;
+      if ((y != ay) || (x != ax)) m_lcd->set_cursor(x, y);
+      m_lcd->write(&text[x], count);
+      memcpy(&ddram[x], &text[x], count);
+      written = true;
+      ax = end;
+      ay = y;
+      x = end;
+    }
+  }
+
+  // Restore the display cursor position
+  if (written && (m_x < WIDTH)) m_lcd->set_cursor(m_x, m_y);
+  return (0);
+}
@@ -37,7 +37,13 @@ NRF24L01P::NRF24L01P(uint16_t net, uint8_t dev,
   m_state(POWER_DOWN_STATE),
   m_trans(0),
   m_retrans(0),
-  m_drops(0)
+  m_drops(0),
+  m_tx_head(0),
+  m_tx_count(0),
+  m_tx_inflight(0),
+  m_tx_dest(0),
+  m_tx_ticket(0),
+  m_tx_handler(NULL)
 {
   channel(64);
 }
@@ -215,11 +221,14 @@ NRF24L01P::send(uint8_t dest, uint8_t port, const iovec_t* vec)
   size_t len = iovec_size(vec);
   if (UNLIKELY(len > PAYLOAD_MAX)) return (EMSGSIZE);
 
+  // Wait for posted messages to complete
+  if (m_tx_count != 0) await();
+
   // Setting transmit destination
   transmit_mode(dest);
 
   // Write source address and payload to the transmit fifo
-  // Fix: Allow larger payload(30*3) with fragmentation
+  // Larger messages may be sent with the Fragment layer
   spi.acquire(this);
     spi.begin();
       uint8_t command = ((dest != BROADCAST)
@@ -293,7 +302,8 @@ NRF24L01P::recv(uint8_t& src, uint8_t& port,
 		void* buf, size_t size,
 		uint32_t ms)
 {
-  // Run in receiver mode
+  // Wait for posted messages to complete and run in receiver mode
+  if (m_tx_count != 0) await();
   receiver_mode();
 
   // Check if there is data available on any pipe
@@ -324,6 +334,168 @@ NRF24L01P::recv(uint8_t& src, uint8_t& port,
   return (count);
 }
 
+int
+NRF24L01P::post(uint8_t dest, uint8_t port, const void* buf, size_t len)
+{
+  // Sanity check the payload size and queue
+  if (UNLIKELY(len > PAYLOAD_MAX)) return (EMSGSIZE);
+  if (UNLIKELY(m_tx_count == TX_QUEUE_MAX)) return (EAGAIN);
+
+  // Append message to the transmit queue and fill the device fifo
+  tx_t* tx = &m_tx_queue[(m_tx_head + m_tx_count) & TX_QUEUE_MASK];
+  tx->dest = dest;
+  tx->port = port;
+  tx->len = len;
+  tx->ticket = m_tx_ticket++;
+  memcpy(tx->payload, buf, len);
+  m_tx_count += 1;
+  tx_fill();
+  return (tx->ticket);
+}
+
+void
+NRF24L01P::await()
+{
+  while (m_tx_count != 0) {
+    tx_service();
+    if (m_tx_count != 0) yield();
+  }
+}
+
+void
+NRF24L01P::on_event(uint8_t type, uint16_t value)
+{
+  UNUSED(value);
+  if (type == Event::SEND_COMPLETED_TYPE) tx_service();
+}
+
+void
+NRF24L01P::tx_fill()
+{
+  while ((m_tx_inflight < m_tx_count) && (m_tx_inflight < TX_INFLIGHT_MAX)) {
+    tx_t* tx = &m_tx_queue[(m_tx_head + m_tx_inflight) & TX_QUEUE_MASK];
+
+    // Set destination and auto-acknowledge pipe(0) when the fifo is
+    // empty. Otherwise only pipeline messages to the same destination
+    if (m_tx_inflight == 0) {
+      transmit_mode(tx->dest);
+      if (tx->dest != BROADCAST) {
+	addr_t tx_addr(m_addr.network, tx->dest);
+	write(RX_ADDR_P0, &tx_addr, sizeof(tx_addr));
+	write(EN_RXADDR, (_BV(ERX_P2) | _BV(ERX_P1) | _BV(ERX_P0)));
+      }
+      m_tx_dest = tx->dest;
+    }
+    else if (tx->dest != m_tx_dest) break;
+
+    // Write source address and payload to the transmit fifo
+    spi.acquire(this);
+      spi.begin();
+	uint8_t command = ((tx->dest != BROADCAST)
+			   ? W_TX_PAYLOAD
+			   : W_TX_PAYLOAD_NO_ACK);
+	m_status = spi.transfer(command);
+	spi.transfer(m_addr.device);
+	spi.transfer(tx->port);
+	spi.write(tx->payload, tx->len);
+      spi.end();
+    spi.release();
+    m_tx_inflight += 1;
+  }
+}
+
+void
+NRF24L01P::tx_service()
+{
+  // Check for messages in the device fifo
+  if (m_tx_inflight == 0) {
+    tx_fill();
+    return;
+  }
+
+  // Complete sent messages. The data sent flag may represent several
+  // messages. On max retransmissions the failed message is left in
+  // the fifo; all messages before it were sent. Otherwise all are
+  // sent if the fifo is empty. Retransmission count is for the latest
+  // message
+  read_status();
+  bool data_sent = m_status.tx_ds;
+  bool max_rt = m_status.max_rt;
+  if (data_sent) {
+    // Max retransmissions may be flagged after the status was read
+    // while the interrupt pin is still asserted by data sent; there
+    // is no new interrupt. Check again after clearing data sent
+    write(STATUS, _BV(TX_DS));
+    if (!max_rt) {
+      read_status();
+      max_rt = m_status.max_rt;
+    }
+    observe_tx_t observe = read_observe_tx();
+    uint8_t done;
+    if (max_rt) {
+      done = m_tx_inflight - 1;
+      observe.arc_cnt = 0;
+    }
+    else if (read_fifo_status().tx_empty) {
+      done = m_tx_inflight;
+    }
+    else {
+      done = m_tx_inflight - 1;
+    }
+    while (done > 1) {
+      tx_complete(0, true);
+      done -= 1;
+    }
+    if (done != 0) tx_complete(observe.arc_cnt, true);
+  }
+
+  // Drop the message on max retransmissions. The fifo is flushed and
+  // reloaded with the remaining messages
+  if (max_rt) {
+    observe_tx_t observe = read_observe_tx();
+    tx_complete(observe.arc_cnt, false);
+    write(FLUSH_TX);
+    write(STATUS, _BV(MAX_RT));
+    m_tx_inflight = 0;
+  }
+
+  // Reload the device fifo
+  tx_fill();
+}
+
+void
+NRF24L01P::tx_complete(uint8_t retrans, bool sent)
+{
+  // Update statistics and remove the oldest message from the queue
+  tx_t* tx = &m_tx_queue[m_tx_head];
+  uint16_t value = tx->ticket | ((uint16_t) retrans << TX_RETRANS_POS);
+  m_trans += 1;
+  m_retrans += retrans;
+  if (!sent) {
+    m_drops += 1;
+    value |= TX_DROPPED;
+  }
+  m_tx_head = (m_tx_head + 1) & TX_QUEUE_MASK;
+  m_tx_inflight -= 1;
+  m_tx_count -= 1;
+
+  // Disable auto-acknowledge pipe(0) when the queue is empty
+  if (m_tx_count == 0)
+    write(EN_RXADDR, (_BV(ERX_P2) | _BV(ERX_P1)));
+
+  // Signal completion
+  if (m_tx_handler != NULL)
+    Event::push(Event::SEND_COMPLETED_TYPE, m_tx_handler, value);
+}
+
+void
+NRF24L01P::IRQPin::on_interrupt(uint16_t arg)
+{
+  UNUSED(arg);
+  if (m_nrf->m_tx_count == 0) return;
+  Event::push(Event::SEND_COMPLETED_TYPE, m_nrf);
+}
+
 void
 NRF24L01P::output_power_level(int8_t dBm)
 {
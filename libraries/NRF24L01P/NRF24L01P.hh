@@ -24,6 +24,7 @@
 #include "Cosa/SPI.hh"
 #include "Cosa/OutputPin.hh"
 #include "Cosa/ExternalInterrupt.hh"
+#include "Cosa/Event.hh"
 #include "Cosa/Wireless.hh"
 #if !defined(BOARD_ATTINYX5)
 
@@ -49,11 +50,23 @@
  *                       +------------+
  * @endcode
  *
+ * @section Asynchronous Transmit
+ * Messages may be posted to a transmit queue with post(). The queue
+ * keeps two messages in the device transmit fifo and the messages
+ * are sent back-to-back. Completion is signaled by the
+ * interrupt pin and handled as an event. A SEND_COMPLETED_TYPE event
+ * is pushed to the transmit handler per message with the ticket
+ * returned by post(), the number of retransmissions and the drop
+ * flag as value (see TX_TICKET_MASK, TX_RETRANS_MASK and TX_DROPPED).
+ * Messages to the same destination are pipelined. The queue is
+ * drained before changing destination, receive and synchronous send.
+ *
  * @section References
  * 1. nRF24L01+ Product Specification (Rev. 1.0)
  * http://www.nordicsemi.com/kor/nordic/download_resource/8765/2/17776224
  */
-class NRF24L01P : protected SPI::Driver, public Wireless::Driver {
+class NRF24L01P : protected SPI::Driver, public Wireless::Driver,
+		  public Event::Handler {
 public:
   /**
    * Maximum size of payload on device.
@@ -192,6 +205,60 @@ public:
    */
   virtual void output_power_level(int8_t dBm);
 
+  /**
+   * Post message in given buffer, with given number of bytes, to the
+   * transmit queue. Returns a ticket (0..255) that is passed in the
+   * completion event if successful otherwise a negative error code;
+   * EMSGSIZE if the number of bytes is greater than PAYLOAD_MAX and
+   * EAGAIN if the transmit queue is full.
+   * @param[in] dest destination network address.
+   * @param[in] port device port (or message type).
+   * @param[in] buf buffer to transmit.
+   * @param[in] len number of bytes in buffer.
+   * @return ticket or negative error code.
+   */
+  int post(uint8_t dest, uint8_t port, const void* buf, size_t len);
+
+  /**
+   * Wait for the transmit queue to become empty. Completions are
+   * handled directly when waiting.
+   */
+  void await();
+
+  /**
+   * Return true(1) if there is room in the transmit queue otherwise
+   * false(0).
+   * @return bool.
+   */
+  virtual bool room()
+  {
+    return (m_tx_count < TX_QUEUE_MAX);
+  }
+
+  /**
+   * Set the handler for transmit completion events. The default
+   * handler is NULL (no completion events).
+   * @param[in] handler for completion events.
+   */
+  void tx_handler(Event::Handler* handler)
+  {
+    m_tx_handler = handler;
+  }
+
+  /**
+   * @override{Event::Handler}
+   * Handle transmit completion events from the interrupt pin.
+   * @param[in] type the event type.
+   * @param[in] value the event value.
+   */
+  virtual void on_event(uint8_t type, uint16_t value);
+
+  /** Transmit completion event value; ticket, retransmissions, drop. */
+  static const uint16_t TX_TICKET_MASK = 0x00ff;
+  static const uint16_t TX_RETRANS_MASK = 0x0f00;
+  static const uint8_t TX_RETRANS_POS = 8;
+  static const uint16_t TX_DROPPED = 0x8000;
+
   /**
    * Return number of transmitted messages.
    * @return transmitt count.
@@ -602,7 +669,8 @@ protected:
   } __attribute__((packed));
 
   /**
-   * Handler for interrupt pin.
+   * Handler for interrupt pin. Pushes an event to the device driver
+   * when there are messages in the transmit queue.
    */
   class IRQPin : public ExternalInterrupt {
   public:
@@ -612,11 +680,45 @@ protected:
       ExternalInterrupt(pin, mode),
       m_nrf(nrf)
     {}
+
+    /**
+     * @override{Interrupt::Handler}
+     * Signal transmit completion to device driver.
+     * @param[in] arg argument from interrupt service routine.
+     */
+    virtual void on_interrupt(uint16_t arg = 0);
+
     friend class NRF24L01P;
   private:
     NRF24L01P* m_nrf;		//!< Device driver.
   };
 
+  /** Transmit fifo depth (ch. 7.5.2, pp. 27). */
+  static const uint8_t TX_FIFO_MAX = 3;
+
+  /**
+   * Max number of messages in the transmit fifo. The fifo status only
+   * gives empty and full; with at most two messages the number of
+   * sent messages is always known from the status flags.
+   */
+  static const uint8_t TX_INFLIGHT_MAX = TX_FIFO_MAX - 1;
+
+  /** Transmit queue size; power of 2. */
+  static const uint8_t TX_QUEUE_MAX = 4;
+  static const uint8_t TX_QUEUE_MASK = TX_QUEUE_MAX - 1;
+
+  /**
+   * Transmit queue entry; message is kept until completed so that
+   * the fifo may be reloaded after a drop.
+   */
+  struct tx_t {
+    uint8_t dest;		//!< Destination device address.
+    uint8_t port;		//!< Port (or message type).
+    uint8_t len;		//!< Payload length.
+    uint8_t ticket;		//!< Completion ticket.
+    uint8_t payload[PAYLOAD_MAX]; //!< Payload.
+  };
+
   OutputPin m_ce;		//!< Chip enable activity RX/TX select pin.
   IRQPin m_irq;			//!< Chip interrupt pin and handler.
   status_t m_status;		//!< Latest status.
@@ -626,6 +728,14 @@ protected:
   uint16_t m_retrans;		//!< Retransmittion count.
   uint16_t m_drops;		//!< Dropped messages.
 
+  tx_t m_tx_queue[TX_QUEUE_MAX]; //!< Transmit queue.
+  uint8_t m_tx_head;		//!< Oldest message in queue.
+  volatile uint8_t m_tx_count;	//!< Number of messages in queue.
+  uint8_t m_tx_inflight;	//!< Number of messages in device fifo.
+  uint8_t m_tx_dest;		//!< Destination of messages in fifo.
+  uint8_t m_tx_ticket;		//!< Next ticket.
+  Event::Handler* m_tx_handler;	//!< Completion event handler.
+
   /**
    * Read status. Issue NOP command to read status.
    * @return status.
@@ -662,6 +772,26 @@ protected:
    */
   void receiver_mode();
 
+  /**
+   * Load messages from the transmit queue to the device fifo. The
+   * fifo is only loaded with messages to the same destination.
+   */
+  void tx_fill();
+
+  /**
+   * Handle transmit status; complete sent and dropped messages and
+   * reload the device fifo.
+   */
+  void tx_service();
+
+  /**
+   * Complete the oldest message in the transmit queue. Update
+   * statistics and push completion event.
+   * @param[in] retrans number of retransmissions.
+   * @param[in] sent true if delivered otherwise false (dropped).
+   */
+  void tx_complete(uint8_t retrans, bool sent);
+
   // Allow operators to access internals
   friend IOStream& operator<<(IOStream& outs, status_t status);
   friend IOStream& operator<<(IOStream& outs, fifo_status_t status);
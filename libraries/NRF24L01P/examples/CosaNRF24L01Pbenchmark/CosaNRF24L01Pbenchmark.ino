@@ -0,0 +1,118 @@
+/**
+ * @file CosaNRF24L01Pbenchmark.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Benchmark NRF24L01P synchronous send and pipelined asynchronous
+ * post. Messages are sent to a receiver node (e.g. CosaWirelessReceiver)
+ * and the completion events are counted.
+ *
+ * @section Circuit
+ * See NRF24L01P.hh for circuit connections.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include <NRF24L01P.h>
+
+#include "Cosa/Event.hh"
+#include "Cosa/RTT.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/UART.hh"
+#include "Cosa/Watchdog.hh"
+
+// Configuration; network and device addresses
+#define NETWORK 0xC05A
+#define DEVICE 0x10
+#define DEST 0x01
+
+NRF24L01P rf(NETWORK, DEVICE);
+
+// Number of messages per measurement and message port
+static const uint16_t COUNT = 100;
+static const uint8_t PORT = 0x20;
+
+/**
+ * Count completed and dropped messages and number of retransmissions.
+ */
+class Completion : public Event::Handler {
+public:
+  Completion() : m_completed(0), m_dropped(0), m_retrans(0) {}
+
+  virtual void on_event(uint8_t type, uint16_t value)
+  {
+    if (type != Event::SEND_COMPLETED_TYPE) return;
+    m_completed += 1;
+    if (value & NRF24L01P::TX_DROPPED) m_dropped += 1;
+    m_retrans += (value & NRF24L01P::TX_RETRANS_MASK)
+      >> NRF24L01P::TX_RETRANS_POS;
+  }
+
+  uint16_t m_completed;
+  uint16_t m_dropped;
+  uint16_t m_retrans;
+};
+
+Completion completion;
+
+void setup()
+{
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaNRF24L01Pbenchmark: started"));
+  Watchdog::begin();
+  RTT::begin();
+  ASSERT(rf.begin());
+  rf.tx_handler(&completion);
+}
+
+void loop()
+{
+  uint8_t msg[NRF24L01P::PAYLOAD_MAX];
+  uint32_t start;
+  uint32_t ms;
+
+  for (uint8_t i = 0; i < sizeof(msg); i++) msg[i] = i;
+
+  // Synchronous send; one message in the fifo at a time
+  start = RTT::millis();
+  for (uint16_t i = 0; i < COUNT; i++)
+    rf.send(DEST, PORT, msg, sizeof(msg));
+  ms = RTT::since(start);
+  trace << PSTR("send:") << (COUNT * sizeof(msg) * 1000L) / ms
+	<< PSTR(" byte/s") << endl;
+
+  // Asynchronous post; keep the fifo filled and dispatch completions
+  Event event;
+  completion.m_completed = 0;
+  completion.m_dropped = 0;
+  completion.m_retrans = 0;
+  start = RTT::millis();
+  for (uint16_t i = 0; i < COUNT; i++) {
+    while (rf.post(DEST, PORT, msg, sizeof(msg)) < 0) {
+      Event::queue.await(&event);
+      event.dispatch();
+    }
+  }
+  rf.await();
+  ms = RTT::since(start);
+  while (Event::queue.dequeue(&event)) event.dispatch();
+  trace << PSTR("post:") << (COUNT * sizeof(msg) * 1000L) / ms
+	<< PSTR(" byte/s, completed=") << completion.m_completed
+	<< PSTR(", dropped=") << completion.m_dropped
+	<< PSTR(", retrans=") << completion.m_retrans
+	<< endl;
+  sleep(2);
+}
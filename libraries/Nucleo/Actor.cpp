@@ -35,42 +35,146 @@ Actor::send(uint8_t port, const void* buf, size_t size)
   sender->m_buf = buf;
 
   // And queue in sending. Resume receiver or next thread
-  Thread* thread = (m_receiving ? this : (Thread*) sender->succ());
+  uint8_t key = lock();
+  bool receiving = m_receiving;
+  wakeup();
   m_sending.attach(sender);
-  sender->resume(thread);
+  unlock(key);
+  sender->resume(receiving ? this : next());
   return (size);
 }
 
 int
-Actor::recv(Actor*& sender, uint8_t& port, void* buf, size_t size)
+Actor::post(uint8_t port, const void* buf, size_t size)
+{
+  // Do not allow post to the running thread or without mailbox
+  if (UNLIKELY(s_running == this || m_mailbox == NULL)) return (EINVAL);
+
+  // Wait for room in the mailbox
+  Actor* sender = (Actor*) s_running;
+  uint8_t key = lock();
+  while (m_count == m_max) {
+    unlock(key);
+    sender->enqueue(&m_posting);
+    key = lock();
+  }
+
+  // Append message to mailbox and schedule receiver
+  uint8_t ix = m_head + m_count;
+  if (ix >= m_max) ix -= m_max;
+  message_t* msg = &m_mailbox[ix];
+  msg->sender = sender;
+  msg->buf = buf;
+  msg->size = size;
+  msg->port = port;
+  msg->posted = true;
+  m_count += 1;
+  sender->m_lent += 1;
+  bool receiving = m_receiving;
+  wakeup();
+  unlock(key);
+
+  // Resume receiver direct if waiting for message and higher priority
+  if (receiving && (m_priority > sender->m_priority)) sender->resume(this);
+  return (size);
+}
+
+int
+Actor::recv(message_t& msg)
 {
   // Do not allow receive of other actor queue
   if (UNLIKELY(s_running != this)) return (EINVAL);
 
   // Check if receiver needs to wait for sending actor
   uint8_t key = lock();
-  if (m_sending.is_empty()) {
+  while (m_count == 0 && m_sending.is_empty()) {
     m_receiving = true;
-    Thread* thread = (Thread*) succ();
     detach();
     unlock(key);
-    resume(thread);
+    resume(next());
     key = lock();
   }
 
-  // Copy sender message parameters
-  int res = -2;
-  sender = (Actor*) m_sending.succ();
-  port = sender->m_port;
-  if (size >= sender->m_size) {
-    memcpy(buf, sender->m_buf, sender->m_size);
-    res = sender->m_size;
+  // Take posted message and schedule an actor waiting for room
+  if (m_count != 0) {
+    msg = m_mailbox[m_head];
+    m_head += 1;
+    if (m_head == m_max) m_head = 0;
+    m_count -= 1;
+    if (!m_posting.is_empty()) schedule((Thread*) m_posting.succ());
   }
-  m_receiving = false;
 
-  // Reschedule the sender
-  succ()->attach(sender);
+  // Or message from sending actor; sender is blocked until released
+  else {
+    Actor* sender = (Actor*) m_sending.succ();
+    sender->detach();
+    msg.sender = sender;
+    msg.buf = sender->m_buf;
+    msg.size = sender->m_size;
+    msg.port = sender->m_port;
+    msg.posted = false;
+  }
+  unlock(key);
+  return (msg.size);
+}
+
+void
+Actor::release(message_t& msg)
+{
+  Actor* sender = msg.sender;
+  if (UNLIKELY(sender == NULL)) return;
+  msg.sender = NULL;
+
+  // Reschedule the sender; posting actor only when flushing
+  uint8_t key = lock();
+  if (msg.posted) {
+    sender->m_lent -= 1;
+    if (sender->m_lent != 0 || !sender->m_flushing) {
+      unlock(key);
+      return;
+    }
+    sender->m_flushing = false;
+  }
+  schedule(sender);
+  unlock(key);
+
+  // Resume sender direct if higher priority
+  if (sender->m_priority > s_running->priority()) s_running->resume(sender);
+}
+
+void
+Actor::flush()
+{
+  // Do not allow flush of other actor
+  if (UNLIKELY(s_running != this)) return;
+
+  // Wait for the posted messages to be released
+  uint8_t key = lock();
+  if (m_lent != 0) {
+    m_flushing = true;
+    detach();
+    unlock(key);
+    resume(next());
+    return;
+  }
   unlock(key);
-  return (res);
 }
 
+int
+Actor::recv(Actor*& sender, uint8_t& port, void* buf, size_t size)
+{
+  // Receive message and copy to buffer
+  message_t msg;
+  int res = recv(msg);
+  if (UNLIKELY(res < 0)) return (res);
+  sender = msg.sender;
+  port = msg.port;
+  if (size >= msg.size)
+    memcpy(buf, msg.buf, msg.size);
+  else
+    res = -2;
+
+  // Reschedule the sender
+  release(msg);
+  return (res);
+}
@@ -26,26 +26,77 @@
 namespace Nucleo {
 
 /**
- * The Cosa Nucleo Actor; message passing supported thread.
+ * The Cosa Nucleo Actor; message passing supported thread. Messages
+ * may be copied to the receiver buffer or borrowed (zero-copy). A
+ * borrowed message buffer belongs to the sender until the receiver
+ * releases the message.
+ *
+ * Messages are either sent (synchronous) or posted (asynchronous).
+ * A sending actor is blocked until the message is released by the
+ * receiver. A posting actor continues and the message is queued in
+ * the receiver mailbox. The posting actor is only blocked when the
+ * mailbox is full. The message buffer may not be modified until
+ * released; flush() waits for all posted messages to be released.
+ *
+ * @section Usage
+ * @code
+ * class Filter : public Nucleo::Actor {
+ * public:
+ *   Filter() : Actor(m_messages, membersof(m_messages)) {}
+ *   virtual void run()
+ *   {
+ *     message_t msg;
+ *     while (1) {
+ *       recv(msg);
+ *       ... process msg.buf and msg.size ...
+ *       release(msg);
+ *     }
+ *   }
+ * private:
+ *   message_t m_messages[4];
+ * };
+ * @endcode
  */
 class Actor : public Thread {
 public:
   /**
-   * Construct actor and initiate internals.
+   * Message descriptor; borrowed message buffer from sender.
+   */
+  struct message_t {
+    Actor* sender;		//!< Sending actor.
+    const void* buf;		//!< Message buffer (borrowed).
+    size_t size;		//!< Message size.
+    uint8_t port;		//!< Port or message identity.
+    bool posted;		//!< Posted (asynchronous) message.
+  };
+
+  /**
+   * Construct actor and initiate internals. Optional mailbox for
+   * posted messages.
+   * @param[in] mailbox message descriptor buffer (default NULL).
+   * @param[in] max number of message descriptors (default 0).
    */
-  Actor() :
+  Actor(message_t* mailbox = NULL, uint8_t max = 0) :
     Thread(),
     m_receiving(false),
     m_sending(),
     m_port(0),
     m_size(0),
-    m_buf(NULL)
+    m_buf(NULL),
+    m_mailbox(mailbox),
+    m_max(max),
+    m_head(0),
+    m_count(0),
+    m_posting(),
+    m_lent(0),
+    m_flushing(false)
   {}
 
   /**
    * Send message in given buffer and with given size to actor. Given port
    * may be used as message identity. Returns size or negative error code.
-   * Receiving actor is resumed.
+   * Receiving actor is resumed. The sending actor is blocked until the
+   * message is released by the receiver.
    * @param[in] port or message identity.
    * @param[in] buf pointer to buffer (default NULL).
    * @param[in] size of message (default 0).
@@ -53,6 +104,20 @@ public:
    */
   int send(uint8_t port, const void* buf = NULL, size_t size = 0);
 
+  /**
+   * Post message in given buffer and with given size to actor
+   * mailbox. The buffer is lent to the receiver and may not be
+   * modified until the message is released (see flush()). Receiving
+   * actor is scheduled but the posting actor continues. The posting
+   * actor is blocked only when the mailbox is full. Returns size or
+   * negative error code(EINVAL) if the actor does not have a mailbox.
+   * @param[in] port or message identity.
+   * @param[in] buf pointer to buffer (default NULL).
+   * @param[in] size of message (default 0).
+   * @return size or negative error code.
+   */
+  int post(uint8_t port, const void* buf = NULL, size_t size = 0);
+
   /**
    * Receive message to given buffer and with given max size to
    * actor. Returns sender, port and size or negative error code.
@@ -65,12 +130,67 @@ public:
    */
   int recv(Actor*& sender, uint8_t& port, void* buf = NULL, size_t size = 0);
 
+  /**
+   * Receive message without copy. The message descriptor holds the
+   * sender, port and borrowed buffer. Posted messages are received
+   * before sent messages. The message must be released when
+   * processed. Returns size or negative error code.
+   * @param[out] msg message descriptor.
+   * @return size or negative error code.
+   */
+  int recv(message_t& msg);
+
+  /**
+   * Release received message and return the buffer to the sender.
+   * Sending actor is rescheduled.
+   * @param[in,out] msg message descriptor.
+   */
+  void release(message_t& msg);
+
+  /**
+   * Wait for all posted messages to be released. The message buffers
+   * may then be reused.
+   */
+  void flush();
+
+  /**
+   * Return number of posted messages that have not been released.
+   * @return number of messages.
+   */
+  uint8_t lent() const
+  {
+    return (m_lent);
+  }
+
 protected:
   volatile bool m_receiving;
   Head m_sending;
   uint8_t m_port;
   size_t m_size;
   const void* m_buf;
+
+  /** Mailbox for posted messages; ring buffer. */
+  message_t* m_mailbox;
+  uint8_t m_max;
+  uint8_t m_head;
+  uint8_t m_count;
+
+  /** Actors waiting for room in mailbox. */
+  Head m_posting;
+
+  /** Number of posted messages not released and flush flag. */
+  uint8_t m_lent;
+  bool m_flushing;
+
+  /**
+   * Schedule the receiving actor if waiting for a message.
+   */
+  void wakeup()
+  {
+    if (!m_receiving) return;
+    m_receiving = false;
+    schedule(this);
+  }
 };
 
 };
@@ -37,12 +37,12 @@ public:
    * should  be initiated with one (which is also the default value).
    * @param[in] sem semaphore to wait.
    */
-  Mutex(Semaphore& sem) : m_sem(sem) { m_sem.wait(); }
+  Mutex(Semaphore& sem) : m_sem(sem) { m_sem.acquire(); }
 
   /**
    * End of mutual exclusion block. Will signal semaphore.
    */
-  ~Mutex() { m_sem.signal(); }
+  ~Mutex() { m_sem.release(); }
 
 private:
   Semaphore& m_sem;
@@ -60,6 +60,6 @@ private:
  * }
  * @endcode
  */
-#define mutex(s) for (uint8_t i = (s.wait(), 1); i != 0; i--, s.signal())
+#define mutex(s) for (uint8_t i = (s.acquire(), 1); i != 0; i--, s.release())
 
 #endif
@@ -44,3 +44,33 @@ Semaphore::signal(uint8_t count, bool flag)
   }
   Thread::s_running->dequeue(&m_queue, flag);
 }
+
+void
+Semaphore::acquire()
+{
+  Thread* running = Thread::s_running;
+  uint8_t key = lock();
+  while (m_count == 0) {
+    // Owner inherits the priority of the waiting thread
+    if (m_owner != NULL && m_owner->m_priority < running->m_priority)
+      m_owner->inherit(running->m_priority);
+    unlock(key);
+    running->enqueue(&m_queue);
+    key = lock();
+  }
+  m_count -= 1;
+  m_owner = running;
+  unlock(key);
+}
+
+void
+Semaphore::release(bool flag)
+{
+  synchronized {
+    if (m_owner != NULL) {
+      m_owner->inherit(m_owner->m_base);
+      m_owner = NULL;
+    }
+  }
+  signal(1, flag);
+}
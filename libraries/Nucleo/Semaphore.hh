@@ -26,8 +26,16 @@
 
 namespace Nucleo {
 
+class Thread;
+
 /**
  * The Cosa Nucleo Semaphore; counting synchronization primitive.
+ * Supports priority inheritance when used as a lock with acquire()
+ * and release() (see Mutex); the thread holding the lock (the owner)
+ * inherits the priority of a waiting thread with higher priority
+ * until it releases the lock. Inheritance is not transitive.
+ * Counting and signalling with wait() and signal() does not track
+ * an owner.
  */
 class Semaphore {
 public:
@@ -35,7 +43,11 @@ public:
    * Construct and initiate semaphore with given counter.
    * @param[in] count initial semaphore value (Default mutex, 1).
    */
-  Semaphore(uint8_t count = 1) : m_queue(), m_count(count) {}
+  Semaphore(uint8_t count = 1) :
+    m_queue(),
+    m_count(count),
+    m_owner(NULL)
+  {}
 
   /**
    * Wait for required count. Threads are queued until count is
@@ -52,12 +64,29 @@ public:
    */
   void signal(uint8_t count = 1, bool flag = true);
 
+  /**
+   * Acquire semaphore as a lock. The running thread becomes the
+   * owner and inherits the priority of higher priority threads
+   * waiting for the lock.
+   */
+  void acquire();
+
+  /**
+   * Release lock acquired by the running thread. Restore owner
+   * priority and signal the semaphore.
+   * @param[in] flag resume waiting thread (Default true).
+   */
+  void release(bool flag = true);
+
 private:
   /** Queue for waiting threads. */
   Head m_queue;
 
   /** Current count. */
   volatile uint8_t m_count;
+
+  /** Thread holding the semaphore as a lock. */
+  Thread* m_owner;
 };
 
 };
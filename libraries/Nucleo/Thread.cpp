@@ -41,45 +41,149 @@ static void thread_sleep(uint16_t s)
 using namespace Nucleo;
 
 Head Thread::s_delayed;
+uint32_t Thread::s_delayed_base = 0L;
+Head Thread::s_ready[PRIORITY_MAX];
+uint8_t Thread::s_ready_map = 0;
 Thread Thread::s_main;
 Thread* Thread::s_running = &s_main;
 size_t Thread::s_top = MAIN_STACK_MAX;
+Thread* Thread::s_threads = NULL;
 
 void
 Thread::init(void* stack)
 {
   UNUSED(stack);
-  s_main.attach(this);
+  schedule(this);
   if (setjmp(m_context)) while (1) run();
 }
 
 void
-Thread::begin(Thread* thread, size_t size)
+Thread::begin(Thread* thread, size_t size, uint8_t priority)
 {
   if (thread != NULL) {
-    void* stack = alloca(s_top);
+    uint8_t* stack = (uint8_t*) alloca(s_top);
+    if (s_main.m_stack == NULL) s_main.paint(stack, MAIN_STACK_MAX);
     s_top += size;
+    thread->paint(stack - size, size);
+    thread->m_priority = priority;
+    thread->m_base = priority;
     thread->init(stack);
   }
   else {
     ::delay = thread_delay;
     ::sleep = thread_sleep;
     ::yield = thread_yield;
+    schedule(&s_main);
   }
 }
 
+size_t
+Thread::stack_used() const
+{
+  if (UNLIKELY(m_stack == NULL)) return (0);
+  const uint8_t* top = m_stack + m_size;
+  const uint8_t* sp = m_stack + sizeof(CANARY);
+  while (sp < top && *sp == PAINT) sp++;
+  return (top - sp);
+}
+
 void
-Thread::run()
+Thread::on_overflow()
 {
-  Thread* thread;
-  if (!s_delayed.is_empty()) {
-    uint32_t now = Watchdog::millis();
-    while ((thread = (Thread*) s_delayed.succ()) != (Thread*) &s_delayed) {
-      if (thread->m_expires > now) break;
-      this->attach(thread);
+  exit(-1);
+}
+
+void
+Thread::print(IOStream& outs)
+{
+  for (Thread* thread = s_threads; thread != NULL; thread = thread->m_next)
+    outs << *thread << endl;
+}
+
+IOStream&
+Nucleo::operator<<(IOStream& outs, const Thread& thread)
+{
+  size_t used = thread.stack_used();
+  outs << PSTR("thread:") << (void*) &thread
+       << PSTR(":size=") << thread.stack_size()
+       << PSTR(",used=") << used
+       << PSTR(",recommend=") << used + Thread::STACK_MARGIN;
+  if (thread.is_overflow()) outs << PSTR(",overflow");
+  return (outs);
+}
+
+void
+Thread::priority(uint8_t level)
+{
+  if (UNLIKELY(level >= PRIORITY_MAX)) level = PRIORITY_MAX - 1;
+  m_base = level;
+  inherit(level);
+}
+
+void
+Thread::inherit(uint8_t level)
+{
+  if (level == m_priority) return;
+
+  // Check if the thread is ready; move to the new ready queue
+  uint8_t key = lock();
+  Head* queue = &s_ready[m_priority];
+  Linkage* link = queue->succ();
+  while (link != queue && link != this) link = link->succ();
+  m_priority = level;
+  if (link == this) schedule(this);
+  unlock(key);
+}
+
+Thread*
+Thread::next()
+{
+  while (1) {
+    // Find highest priority non-empty ready queue. Clear bits for
+    // queues that have become empty
+    uint8_t key = lock();
+    uint8_t map = s_ready_map;
+    while (map != 0) {
+      uint8_t level = (map & 0x0c) ?
+	((map & 0x08) ? 3 : 2) :
+	((map & 0x02) ? 1 : 0);
+      Thread* thread = (Thread*) s_ready[level].succ();
+      if (thread != (Thread*) &s_ready[level]) {
+	s_ready_map = map;
+	unlock(key);
+	return (thread);
+      }
+      map &= ~_BV(level);
     }
+    s_ready_map = 0;
+    unlock(key);
+
+    // No ready threads; wait for a delayed thread to expire
+    Power::sleep();
+    tick();
+  }
+}
+
+void
+Thread::tick()
+{
+  if (s_delayed.is_empty()) return;
+  uint32_t elapsed = Watchdog::millis() - s_delayed_base;
+  Thread* thread;
+  while ((thread = (Thread*) s_delayed.succ()) != (Thread*) &s_delayed) {
+    if (thread->m_delta > elapsed) break;
+    elapsed -= thread->m_delta;
+    s_delayed_base += thread->m_delta;
+    schedule(thread);
   }
-  thread = (Thread*) succ();
+}
+
+void
+Thread::run()
+{
+  tick();
+  schedule(this);
+  Thread* thread = next();
   if (thread != this)
     resume(thread);
   else
@@ -89,17 +193,26 @@ Thread::run()
 void
 Thread::resume(Thread* thread)
 {
+  if (UNLIKELY(is_overflow())) on_overflow();
   if (setjmp(m_context)) return;
   s_running = thread;
   longjmp(thread->m_context, 1);
 }
 
+void
+Thread::yield()
+{
+  tick();
+  schedule(this);
+  Thread* thread = next();
+  if (thread != this) resume(thread);
+}
+
 void
 Thread::enqueue(Head* queue, Thread* thread)
 {
-  if (thread == NULL)
-    thread = (Thread*) succ();
   queue->attach(this);
+  if (thread == NULL) thread = next();
   resume(thread);
 }
 
@@ -108,24 +221,33 @@ Thread::dequeue(Head* queue, bool flag)
 {
   if (UNLIKELY(queue->is_empty())) return;
   Thread* thread = (Thread*) queue->succ();
-  if (flag) {
-    attach(thread);
+  schedule(thread);
+  if (thread->m_priority > m_priority
+      || (flag && thread->m_priority == m_priority))
     resume(thread);
-  }
-  else {
-    succ()->attach(thread);
-  }
 }
 
 void
 Thread::delay(uint32_t ms)
 {
-  m_expires = Watchdog::millis() + ms;
+  // Convert to time relative the delta list time base
+  uint32_t now = Watchdog::millis();
+  if (s_delayed.is_empty())
+    s_delayed_base = now;
+  else
+    ms += now - s_delayed_base;
+
+  // Find position in delta list and adjust successor delta
   Thread* thread = (Thread*) s_delayed.succ();
   while (thread != (Thread*) &s_delayed) {
-    if (thread->m_expires > m_expires) break;
+    if (thread->m_delta > ms) {
+      thread->m_delta -= ms;
+      break;
+    }
+    ms -= thread->m_delta;
     thread = (Thread*) thread->succ();
   }
+  m_delta = ms;
   enqueue((Head*) thread);
 }
 
@@ -23,15 +23,51 @@
 
 #include "Cosa/Types.h"
 #include "Cosa/Linkage.hh"
+#include "Cosa/IOStream.hh"
 #include <setjmp.h>
 
 namespace Nucleo {
 
 /**
- * The Cosa Nucleo Thread; run-to-completion multi-tasking.
+ * The Cosa Nucleo Thread; run-to-completion multi-tasking with fixed
+ * priority scheduling. Ready threads are kept in a queue per priority
+ * level and the highest priority ready thread is selected with a
+ * bitmap of non-empty queues. Threads with the same priority are
+ * scheduled round-robin. The main thread has the lowest priority
+ * (zero), which is also the default thread priority.
+ *
+ * Scheduling is cooperative; a thread runs until it yields, blocks or
+ * wakes a higher priority thread. A thread that polls with yield()
+ * will only give way to threads with the same or higher priority and
+ * should block with delay() or a semaphore.
  */
 class Thread : public Link {
 public:
+  /** Number of priority levels. */
+  static const uint8_t PRIORITY_MAX = 4;
+
+  /** Stack paint pattern. */
+  static const uint8_t PAINT = 0xc5;
+
+  /** Stack canary; at the bottom of the stack. */
+  static const uint16_t CANARY = 0xa55a;
+
+  /** Recommended stack margin for interrupt handlers. */
+  static const size_t STACK_MARGIN = 24;
+
+  /**
+   * Construct thread with lowest priority.
+   */
+  Thread() :
+    Link(),
+    m_delta(0),
+    m_priority(0),
+    m_base(0),
+    m_stack(NULL),
+    m_size(0),
+    m_next(NULL)
+  {}
+
   /**
    * Return running thread.
    * @return thread.
@@ -42,12 +78,32 @@ public:
   }
 
   /**
-   * Schedule static thread with given stack size. Using the default
-   * parameters will start the main thread.
+   * Schedule static thread with given stack size and priority. Using
+   * the default parameters will start the main thread. The stack is
+   * painted and a canary is written at the bottom of the stack. The
+   * canary is checked on every context switch.
    * @param[in] thread to initiate and schedule.
    * @param[in] size of stack.
+   * @param[in] priority level (Default lowest, 0).
+   */
+  static void begin(Thread* thread = NULL, size_t size = 0,
+		    uint8_t priority = 0);
+
+  /**
+   * Return current priority level. May be higher than the assigned
+   * priority when inherited from a waiting thread.
+   * @return priority level.
    */
-  static void begin(Thread* thread = NULL, size_t size = 0);
+  uint8_t priority() const
+  {
+    return (m_priority);
+  }
+
+  /**
+   * Set priority level (0..PRIORITY_MAX-1).
+   * @param[in] level priority.
+   */
+  void priority(uint8_t level);
 
   /**
    * @override{Nucleo::Thread}
@@ -69,16 +125,10 @@ public:
   void resume(Thread* thread);
 
   /**
-   * Yield control to the next thread in the thread queue. Preserve
-   * stack and machine state and later continue.
+   * Yield control to the next thread with the same or higher
+   * priority. Preserve stack and machine state and later continue.
    */
-  void yield()
-    __attribute__((always_inline))
-  {
-    Thread* thread = (Thread*) succ();
-    if (thread == this) thread = &s_main;
-    resume(thread);
-  }
+  void yield();
 
   /**
    * Delay at least the given time period in milli-seconds. The resolution
@@ -98,7 +148,9 @@ public:
 
   /**
    * If given queue is not empty dequeue first thread and resume
-   * direct if flag is true otherwise enqueue first in run queue.
+   * direct if flag is true otherwise enqueue in run queue. A thread
+   * with higher priority is always resumed direct and a thread with
+   * lower priority is always enqueued.
    * @param[in] queue to transfer from.
    * @param[in] flag resume direct otherwise on yield (Default true).
    */
@@ -110,14 +162,74 @@ public:
    */
   static void service();
 
+  /**
+   * Return thread stack size. The main thread stack size is the
+   * stack reserved below the caller of the first begin().
+   * @return number of bytes.
+   */
+  size_t stack_size() const
+  {
+    return (m_size);
+  }
+
+  /**
+   * Return thread stack high water mark; number of bytes used of the
+   * thread stack. The stack is painted when the thread is started.
+   * @return number of bytes.
+   */
+  size_t stack_used() const;
+
+  /**
+   * Return true(1) if the stack canary has been overwritten otherwise
+   * false(0).
+   * @return bool.
+   */
+  bool is_overflow() const
+  {
+    return ((m_stack != NULL) && (*((uint16_t*) m_stack) != CANARY));
+  }
+
+  /**
+   * @override{Nucleo::Thread}
+   * Called on context switch when the stack canary of the thread has
+   * been overwritten. The default implementation calls exit().
+   */
+  virtual void on_overflow();
+
+  /**
+   * Print stack report for all threads to given output stream; size,
+   * high water mark and recommended size (high water mark and
+   * interrupt handler margin).
+   * @param[in] outs output stream.
+   */
+  static void print(IOStream& outs);
+
+  /**
+   * Print thread stack size, high water mark and recommended size
+   * to given output stream.
+   * @param[in] outs output stream.
+   * @param[in] thread to print.
+   * @return output stream.
+   */
+  friend IOStream& operator<<(IOStream& outs, const Thread& thread);
+
 protected:
   /** Size of main thread stack. */
   static const size_t MAIN_STACK_MAX = 64;
 
-  /** Queue for delayed threads. */
+  /** Queue for delayed threads; sorted delta list. */
   static Head s_delayed;
 
-  /** Main thread and thread queue head. */
+  /** Time base for the first delayed thread delta. */
+  static uint32_t s_delayed_base;
+
+  /** Queue per priority level for ready threads. */
+  static Head s_ready[PRIORITY_MAX];
+
+  /** Bitmap of (possibly) non-empty ready queues. */
+  static uint8_t s_ready_map;
+
+  /** Main thread. */
   static Thread s_main;
 
   /** Running thread. */
@@ -126,11 +238,25 @@ protected:
   /** Top of stack allocation. */
   static size_t s_top;
 
+  /** List of started threads. */
+  static Thread* s_threads;
+
   /** Thread context. */
   jmp_buf m_context;
 
-  /** Delay time expires; should not run for more than 2**32 seconds. */
-  uint32_t m_expires;
+  /** Delay time in milli-seconds relative to predecessor. */
+  uint32_t m_delta;
+
+  /** Current and assigned priority level. */
+  uint8_t m_priority;
+  uint8_t m_base;
+
+  /** Thread stack bottom (canary) and size. */
+  uint8_t* m_stack;
+  size_t m_size;
+
+  /** Next started thread. */
+  Thread* m_next;
 
   /**
    * Initiate thread and prepare for initial call to virtual member
@@ -139,6 +265,54 @@ protected:
    */
   void init(void* stack);
 
+  /**
+   * Paint given stack area, write canary and add thread to list of
+   * started threads. The stack area is below the stack pointer in
+   * begin() and must be painted without function calls.
+   * @param[in] bottom of stack area.
+   * @param[in] size of stack area.
+   */
+  void paint(uint8_t* bottom, size_t size)
+    __attribute__((always_inline))
+  {
+    volatile uint8_t* sp = bottom + size;
+    while (sp != bottom) *--sp = PAINT;
+    *((uint16_t*) bottom) = CANARY;
+    m_stack = bottom;
+    m_size = size;
+    m_next = s_threads;
+    s_threads = this;
+  }
+
+  /**
+   * Enqueue given thread last in the ready queue for its priority.
+   * @param[in] thread to schedule.
+   */
+  static void schedule(Thread* thread)
+  {
+    s_ready[thread->m_priority].attach(thread);
+    s_ready_map |= _BV(thread->m_priority);
+  }
+
+  /**
+   * Return highest priority ready thread. Will sleep until a delayed
+   * thread expires if there are no ready threads.
+   * @return thread.
+   */
+  static Thread* next();
+
+  /**
+   * Reschedule delayed threads that have expired.
+   */
+  static void tick();
+
+  /**
+   * Set current priority level and reschedule if ready. Used for
+   * priority inheritance.
+   * @param[in] level priority.
+   */
+  void inherit(uint8_t level);
+
   /** Allow friends to use the queue member functions. */
   friend class Semaphore;
 };
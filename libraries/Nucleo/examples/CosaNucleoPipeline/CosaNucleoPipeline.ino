@@ -0,0 +1,136 @@
+/**
+ * @file CosaNucleoPipeline.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Demonstration of Cosa Nucleo Actors zero-copy message passing.
+ * A producer posts sample blocks to a filter actor which forwards
+ * the borrowed block to a consumer actor. No message data is copied.
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include <Nucleo.h>
+
+#include "Cosa/Trace.hh"
+#include "Cosa/Watchdog.hh"
+#include "Cosa/UART.hh"
+
+// Sample block size and number of blocks
+static const size_t BLOCK_MAX = 32;
+static const uint8_t BLOCKS = 2;
+
+// Print sum of sample block
+class Consumer : public Nucleo::Actor {
+public:
+  virtual void run();
+};
+
+void
+Consumer::run()
+{
+  message_t msg;
+  while (1) {
+    recv(msg);
+    const uint8_t* bp = (const uint8_t*) msg.buf;
+    uint16_t sum = 0;
+    for (size_t i = 0; i < msg.size; i++) sum += bp[i];
+    trace << Watchdog::millis()
+	  << PSTR(":Consumer:port=") << msg.port
+	  << PSTR(",sum=") << sum
+	  << endl;
+    release(msg);
+  }
+}
+
+// Forward borrowed sample blocks to consumer
+class Filter : public Nucleo::Actor {
+public:
+  Filter(Actor* consumer) :
+    Actor(m_messages, membersof(m_messages)),
+    m_consumer(consumer)
+  {}
+  virtual void run();
+private:
+  message_t m_messages[BLOCKS];
+  Actor* m_consumer;
+};
+
+void
+Filter::run()
+{
+  message_t msg;
+  while (1) {
+    recv(msg);
+    m_consumer->send(msg.port, msg.buf, msg.size);
+    release(msg);
+  }
+}
+
+// Post sample blocks to filter; double buffering
+class Producer : public Nucleo::Actor {
+public:
+  Producer(Actor* filter) :
+    Actor(),
+    m_filter(filter)
+  {}
+  virtual void run();
+private:
+  uint8_t m_block[BLOCKS][BLOCK_MAX];
+  Actor* m_filter;
+};
+
+void
+Producer::run()
+{
+  uint8_t nr = 0;
+  while (1) {
+    for (uint8_t i = 0; i < BLOCKS; i++) {
+      for (size_t j = 0; j < BLOCK_MAX; j++) m_block[i][j] = nr + j;
+      m_filter->post(nr++, m_block[i], BLOCK_MAX);
+    }
+    flush();
+    delay(500);
+  }
+}
+
+Consumer consumer;
+Filter filter(&consumer);
+Producer producer(&filter);
+
+void setup()
+{
+  // Start serial as trace iostream
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaNucleoPipeline: started"));
+
+  // Start watchdog timer as clock
+  Watchdog::begin();
+
+  // Start the actors
+  Nucleo::Thread::begin(&producer, 128);
+  Nucleo::Thread::begin(&filter, 128);
+  Nucleo::Thread::begin(&consumer, 128);
+
+  // Start the main thread
+  Nucleo::Thread::begin();
+}
+
+void loop()
+{
+  // Service the nucleos
+  Nucleo::Thread::service();
+}
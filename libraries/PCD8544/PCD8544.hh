@@ -33,7 +33,8 @@
  * for IOStream access. Binding to trace, etc. Supports simple text
  * scroll, cursor, and handling of special characters such as
  * form-feed, back-space and new-line. Graphics may be performed
- * with OffScreen Canvas and copied to the display with draw_bitmap().
+ * with OffScreen Canvas and copied to the display with
+ * OffScreen::flush() (modified pages only) or draw_bitmap().
  *
  * @section Circuit
  * PCD8544 is a low voltage device (3V3) and signals require level
@@ -155,8 +155,7 @@ void setup()
   offscreen.draw_string(PSTR("OffScreen"));
 
   // Draw the off-screen canvas on the LCD
-  lcd.set_cursor(0, 0);
-  lcd.draw_bitmap(offscreen.bitmap(), offscreen.WIDTH, offscreen.HEIGHT);
+  offscreen.flush(&lcd);
   sleep(4);
 #endif
 }
@@ -208,7 +207,7 @@ void loop()
 
     // Draw the off-screen canvas on the LCD
     lcd.putchar('\f');
-    lcd.draw_bitmap(offscreen.bitmap(), offscreen.WIDTH, offscreen.HEIGHT);
+    offscreen.flush(&lcd);
 
     // Decrement counter
     if (sec == 0) {
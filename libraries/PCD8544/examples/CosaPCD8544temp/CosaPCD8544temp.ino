@@ -135,8 +135,7 @@ void loop()
   console << sensor;
 
   // Draw the bitmap to the LCD screen
-  lcd.set_cursor(0, 0);
-  lcd.draw_bitmap(offscreen.bitmap(), offscreen.WIDTH, offscreen.HEIGHT);
+  offscreen.flush(&lcd);
 
   // Take a nap
   sleep(2);
@@ -22,32 +22,37 @@
 #include "Cosa/Watchdog.hh"
 
 Head ProtoThread::runq;
+Head ProtoThread::waitq;
 
 void
 ProtoThread::on_event(uint8_t type, uint16_t value)
 {
-  if (UNLIKELY(m_state == WAITING)) detach();
+  if (UNLIKELY(m_state == WAITING || m_state == AWAITING)) detach();
   m_state = (type == Event::TIMEOUT_TYPE) ? TIMEOUT : RUNNING;
   on_run(type, value);
-  if (m_state == RUNNING) {
-    m_state = READY;
-  }
-  else if (m_state == TIMEOUT) {
-    schedule(this);
-  }
+  if (m_state == RUNNING || m_state == TIMEOUT) schedule(this);
 }
 
 uint16_t
 ProtoThread::dispatch(bool flag)
 {
   uint16_t count = 0;
-  // Check if events should be processed and the run queue is empty
-  if (flag && runq.is_empty()) {
+
+  // Check if events should be processed. Sleep and wait for an event
+  // if the run queue is empty
+  if (flag) {
     Event event;
-    Event::queue.await(&event);
-    event.dispatch();
-    count += 1;
+    if (runq.is_empty()) {
+      Event::queue.await(&event);
+      event.dispatch();
+      count += 1;
+    }
+    while (Event::queue.dequeue(&event)) {
+      event.dispatch();
+      count += 1;
+    }
   }
+
   // Iterate once through the run queue and call all threads run method
   Linkage* link = runq.succ();
   while (link != &runq) {
@@ -60,16 +65,8 @@ ProtoThread::dispatch(bool flag)
     }
     link = succ;
     count += 1;
-    // Check if events should be processed
-    if (flag) {
-      while (Event::queue.available()) {
-	Event event;
-	Event::queue.dequeue(&event);
-	event.dispatch();
-	count += 1;
-      }
-    }
   }
+
   // Return total number of function dispatch
   return (count);
 }
@@ -31,6 +31,15 @@
  * context using minimal memory per protothread. Cosa/Thread supports
  * event to thread mapping and timers.
  *
+ * Threads are kept in three queues; the run queue (READY), the job
+ * scheduler timer queue (WAITING) and the event wait queue
+ * (AWAITING). Only threads in the run queue are dispatched. Timer
+ * and event waiting threads are run when the timeout or event is
+ * delivered. The dispatcher will sleep, and wait for the next event,
+ * when the run queue is empty. PROTO_THREAD_AWAIT() polls the
+ * condition and keeps the thread in the run queue; use
+ * PROTO_THREAD_AWAIT_EVENT() or PROTO_THREAD_DELAY() to allow sleep.
+ *
  * @section Limitations
  * The thread macro set should only be used within the
  * ProtoThread::on_run() function. The macros cannot be used in
@@ -61,6 +70,7 @@ public:
     TIMEOUT,			//!< Timeout received and running.
     RUNNING,			//!< Dispatched and running.
     SLEEPING,			//!< Detached. Need wakeup call.
+    AWAITING,			//!< In event wait queue.
     TERMINATED = 0xff,		//!< Removed from all queues.
   } __attribute__((packed));
 
@@ -129,6 +139,17 @@ public:
     detach();
   }
 
+  /**
+   * Enqueue thread in the event wait queue. The thread is run when
+   * an event is received.
+   */
+  void await_event()
+    __attribute__((always_inline))
+  {
+    m_state = AWAITING;
+    waitq.attach(this);
+  }
+
   /**
    * Check if the timer expired; i.e., the thread is in TIMEOUT
    * state.
@@ -161,9 +182,11 @@ public:
 
   /**
    * Run threads in the run queue. If given flag is true events will
-   * be processes. Returns number of dispatched threads and events.
-   * The run queue is only iterated once per call to dispatch to allow
-   * user defined outer loop, i.e., arduino loop() function.
+   * be processes before the run queue is iterated, and if the run
+   * queue is empty the dispatcher will sleep and wait for an event.
+   * Returns number of dispatched threads and events. The run queue
+   * is only iterated once per call to dispatch to allow user defined
+   * outer loop, i.e., arduino loop() function.
    * @param[in] flag process events if non zero.
    * @return number of dispatched threads and events.
    */
@@ -178,13 +201,15 @@ public:
 
 protected:
   static Head runq;
+  static Head waitq;
   uint8_t m_state;
   void* m_ip;
 
   /**
    * @override{Event::Handler}
    * The first level event handler. Filters timeout events and
-   * run the thread action function.
+   * run the thread action function. A thread in the timer or event
+   * wait queue is rescheduled.
    * @param[in] type the type of event.
    * @param[in] value the event value.
    */
@@ -222,13 +247,25 @@ protected:
   } while (0)
 
 /**
- * Schedule the given thread if SLEEPING.
+ * Schedule the given thread if SLEEPING or AWAITING.
  * @param[in] thread to wake.
  */
 #define PROTO_THREAD_WAKE(thread)			\
   do {							\
-    if (thread->m_state == SLEEPING)			\
-      Thread::schedule(thread);				\
+    if (thread->m_state == SLEEPING			\
+	|| thread->m_state == AWAITING)			\
+      ProtoThread::schedule(thread);			\
+  } while (0)
+
+/**
+ * Yield execution and enqueue in the event wait queue. The thread
+ * continues when an event is received (see on_run() type and value
+ * parameters) or with PROTO_THREAD_WAKE().
+ */
+#define PROTO_THREAD_AWAIT_EVENT()			\
+  do {							\
+    await_event();					\
+    PROTO_THREAD_YIELD();				\
   } while (0)
 
 /**
@@ -180,42 +180,99 @@ SD::receive()
 }
 
 bool
-SD::read(CMD command, uint32_t arg, void* buf, size_t count)
+SD::await_ready(uint16_t ms)
+{
+  uint16_t start = RTT::millis();
+  do {
+    if (spi.transfer(0xff) == 0xff) return (true);
+  } while (((uint16_t) RTT::millis()) - start < ms);
+  return (false);
+}
+
+bool
+SD::receive_data(void* buf, size_t count)
 {
   uint8_t* dst = (uint8_t*) buf;
   uint16_t crc = 0;
-  bool res = false;
   uint8_t data;
 
-  // Issue read command and receive data into buffer
-  spi.acquire(this);
-    spi.begin();
-      if (send(command, arg)) goto error;
-      if (!await(READ_TIMEOUT, DATA_START_BLOCK)) goto error;
+  // Wait for start of data block
+  if (!await(READ_TIMEOUT, DATA_START_BLOCK)) return (false);
 
+  // Receive data into buffer and calculate check sum
 #if defined(USE_SPI_PREFETCH)
-      spi.transfer_start(0xff);
-      while (--count) {
-	data = spi.transfer_next(0xff);
-	*dst++ = data;
-	crc = _crc_xmodem_update(crc, data);
-      }
-      data = spi.transfer_await();
-      *dst = data;
-      crc = _crc_xmodem_update(crc, data);
+  spi.transfer_start(0xff);
+  while (--count) {
+    data = spi.transfer_next(0xff);
+    *dst++ = data;
+    crc = _crc_xmodem_update(crc, data);
+  }
+  data = spi.transfer_await();
+  *dst = data;
+  crc = _crc_xmodem_update(crc, data);
 #else
-      do {
-	uint8_t data = spi.transfer(0xff);
-	*dst++ = data;
-	crc = _crc_xmodem_update(crc, data);
-      } while (--count);
+  do {
+    data = spi.transfer(0xff);
+    *dst++ = data;
+    crc = _crc_xmodem_update(crc, data);
+  } while (--count);
 #endif
 
-      // Receive the check sum and check
-      crc = _crc_xmodem_update(crc, spi.transfer(0xff));
-      crc = _crc_xmodem_update(crc, spi.transfer(0xff));
-      res = (crc == 0);
+  // Receive the check sum and check
+  crc = _crc_xmodem_update(crc, spi.transfer(0xff));
+  crc = _crc_xmodem_update(crc, spi.transfer(0xff));
+  return (crc == 0);
+}
 
+bool
+SD::transmit_data(uint8_t token, const uint8_t* src)
+{
+  uint16_t crc = 0;
+  uint16_t count = BLOCK_MAX;
+  uint8_t status;
+  uint8_t data;
+
+  // Transfer start token, block and calculate check sum
+  spi.transfer(token);
+#if defined(USE_SPI_PREFETCH)
+  data = *src++;
+  spi.transfer_start(data);
+  while (--count) {
+    crc = _crc_xmodem_update(crc, data);
+    data = *src++;
+    spi.transfer_await();
+    spi.transfer_start(data);
+  }
+  crc = _crc_xmodem_update(crc, data);
+  spi.transfer_await();
+#else
+  do {
+    data = *src++;
+    spi.transfer(data);
+    crc = _crc_xmodem_update(crc, data);
+  } while (--count);
+#endif
+
+  // Transfer the check sum and receive data response token and check status
+  spi.transfer(crc >> 8);
+  spi.transfer(crc);
+  status = spi.transfer(0xff);
+  return ((status & DATA_RES_MASK) == DATA_RES_ACCEPTED);
+}
+
+bool
+SD::read(CMD command, uint32_t arg, void* buf, size_t count)
+{
+  bool res = false;
+
+  // Not allowed during multiple block transfer
+  if (UNLIKELY(m_stream != NO_STREAM)) return (false);
+
+  // Issue read command and receive data into buffer
+  spi.acquire(this);
+    spi.begin();
+      if (send(command, arg)) goto error;
+      res = receive_data(buf, count);
  error:
     spi.end();
   spi.release();
@@ -282,6 +339,9 @@ SD::begin(SPI::Clock rate)
 bool
 SD::end()
 {
+  // Terminate any multiple block transfer session in progress
+  if (m_stream == READ_STREAM) return (end_read());
+  if (m_stream == WRITE_STREAM) return (end_write());
   return (true);
 }
 
@@ -290,6 +350,9 @@ SD::erase(uint32_t start, uint32_t end)
 {
   bool res = false;
 
+  // Not allowed during multiple block transfer
+  if (UNLIKELY(m_stream != NO_STREAM)) return (false);
+
   // Check if block address should be mapped to byte address
   if (m_type != TYPE_SDHC) {
     start <<= 9;
@@ -313,45 +376,20 @@ SD::erase(uint32_t start, uint32_t end)
 bool
 SD::write(uint32_t block, const uint8_t* src)
 {
-  uint16_t crc = 0;
-  uint16_t count = BLOCK_MAX;
   uint8_t status;
-  uint8_t data;
   bool res = false;
 
+  // Not allowed during multiple block transfer
+  if (UNLIKELY(m_stream != NO_STREAM)) return (false);
+
   // Check for byte address adjustment
   if (m_type != TYPE_SDHC) block <<= 9;
 
-  // Issue write block command, transfer block, calculate check sum
+  // Issue write block command, transfer block and check data response
   spi.acquire(this);
     spi.begin();
       if (send(WRITE_BLOCK, block)) goto error;
-      spi.transfer(DATA_START_BLOCK);
-
-#if defined(USE_SPI_PREFETCH)
-      data = *src++;
-      spi.transfer_start(data);
-      while (--count) {
-	crc = _crc_xmodem_update(crc, data);
-	data = *src++;
-	spi.transfer_await();
-	spi.transfer_start(data);
-      }
-      crc = _crc_xmodem_update(crc, data);
-      spi.transfer_await();
-#else
-      do {
-	data = *src++;
-	spi.transfer(data);
-	crc = _crc_xmodem_update(crc, data);
-      } while (--count);
-#endif
-
-      // Transfer the check sum and receive data response token and check status
-      spi.transfer(crc >> 8);
-      spi.transfer(crc);
-      status = spi.transfer(0xff);
-      if ((status & DATA_RES_MASK) != DATA_RES_ACCEPTED) goto error;
+      if (!transmit_data(DATA_START_BLOCK, src)) goto error;
 
       // Wait for the write operation to complete and check status
       if (!await(WRITE_TIMEOUT)) goto error;
@@ -366,3 +404,110 @@ SD::write(uint32_t block, const uint8_t* src)
   return (res);
 }
 
+bool
+SD::begin_read(uint32_t block)
+{
+  // Check that there is no session in progress
+  if (UNLIKELY(m_stream != NO_STREAM)) return (false);
+
+  // Check for byte address adjustment
+  if (m_type != TYPE_SDHC) block <<= 9;
+
+  // Issue read multiple block command. Hold the bus during the session
+  spi.acquire(this);
+    spi.begin();
+      if (send(READ_MULTIPLE_BLOCK, block)) goto error;
+      m_stream = READ_STREAM;
+      return (true);
+ error:
+    spi.end();
+  spi.release();
+  return (false);
+}
+
+bool
+SD::read_next(uint8_t* dst)
+{
+  if (UNLIKELY(m_stream != READ_STREAM)) return (false);
+  return (receive_data(dst, BLOCK_MAX));
+}
+
+bool
+SD::end_read()
+{
+  bool res = false;
+
+  // Check that there is a read session in progress
+  if (UNLIKELY(m_stream != READ_STREAM)) return (false);
+  m_stream = NO_STREAM;
+
+  // Stop the transmission and wait for the card to become ready
+      if (send(STOP_TRANSMISSION)) goto error;
+      res = await_ready(READ_TIMEOUT);
+ error:
+    spi.end();
+  spi.release();
+  return (res);
+}
+
+bool
+SD::begin_write(uint32_t block, uint32_t count)
+{
+  // Check that there is no session in progress
+  if (UNLIKELY(m_stream != NO_STREAM)) return (false);
+
+  // Check for byte address adjustment
+  if (m_type != TYPE_SDHC) block <<= 9;
+
+  // Issue pre-erase hint and write multiple block command. Hold the
+  // bus during the session
+  spi.acquire(this);
+    spi.begin();
+      if ((count != 0L) && send(SET_WR_BLK_ERASE_COUNT, count)) goto error;
+      if (send(WRITE_MULTIPLE_BLOCK, block)) goto error;
+      m_stream = WRITE_STREAM;
+      return (true);
+ error:
+    spi.end();
+  spi.release();
+  return (false);
+}
+
+bool
+SD::write_next(const uint8_t* src)
+{
+  // Check that there is a write session in progress
+  if (UNLIKELY(m_stream != WRITE_STREAM)) return (false);
+
+  // Transfer the block and wait for the card to complete programming
+  if (!transmit_data(WRITE_MULTIPLE_TOKEN, src)) return (false);
+  return (await_ready(WRITE_TIMEOUT));
+}
+
+bool
+SD::end_write()
+{
+  uint8_t status;
+  bool res = false;
+
+  // Check that there is a write session in progress
+  if (UNLIKELY(m_stream != WRITE_STREAM)) return (false);
+  m_stream = NO_STREAM;
+
+  // Send stop transmission token and wait for programming to complete
+      if (!await_ready(WRITE_TIMEOUT)) goto error;
+      spi.transfer(STOP_TRAN_TOKEN);
+      spi.transfer(0xff);
+      if (!await_ready(WRITE_TIMEOUT)) goto error;
+
+      // Check status
+      status = send(SEND_STATUS);
+      if (status != 0) goto error;
+      status = spi.transfer(0xff);
+      res = (status == 0);
+
+ error:
+    spi.end();
+  spi.release();
+  return (res);
+}
@@ -307,12 +307,22 @@ protected:
   static const uint8_t INIT_RETRY = 200;
   static const uint8_t RESPONSE_RETRY = 100;
 
+  /** Multiple block transfer session state. */
+  enum STREAM {
+    NO_STREAM = 0,		//!< No multiple block transfer.
+    READ_STREAM = 1,		//!< READ_MULTIPLE_BLOCK in progress.
+    WRITE_STREAM = 2		//!< WRITE_MULTIPLE_BLOCK in progress.
+  } __attribute__((packed));
+
   /** Response from latest command. */
   uint8_t m_response;
 
   /** Detected card type. */
   CARD m_type;
 
+  /** Current multiple block transfer session. */
+  STREAM m_stream;
+
   /**
    * Send given command and argument. Returns R1 response byte.
    * @param[in] command to send.
@@ -379,6 +389,37 @@ protected:
    */
   bool read(CMD command, uint32_t arg, void* buf, size_t count);
 
+  /**
+   * Wait for the card to release the busy signal (data line high).
+   * Wait for at most given period in milli-seconds. Return true if
+   * the card is ready otherwise false if the time limit was exceeded.
+   * @param[in] ms timeout period in number of milli-seconds.
+   * @return bool.
+   */
+  bool await_ready(uint16_t ms);
+
+  /**
+   * Await data start token and receive data block with given number
+   * of bytes into given buffer, and check the block check sum (CRC16).
+   * Should be called with the bus acquired. Returns true if
+   * successful otherwise false.
+   * @param[in] buf pointer to buffer for data block.
+   * @param[in] count number of bytes.
+   * @return bool.
+   */
+  bool receive_data(void* buf, size_t count);
+
+  /**
+   * Transmit given start token and data block with BLOCK_MAX bytes
+   * from given buffer with check sum (CRC16). Should be called with
+   * the bus acquired. Returns true if the block was accepted by the
+   * card otherwise false.
+   * @param[in] token data start token.
+   * @param[in] src pointer to source buffer.
+   * @return bool.
+   */
+  bool transmit_data(uint8_t token, const uint8_t* src);
+
 public:
   /**
    * Construct Secure Disk low-level SPI device driver with given chip
@@ -388,17 +429,20 @@ public:
 #if defined(BOARD_ATTINYX5)
   SD(Board::DigitalPin csn = Board::D3) :
     SPI::Driver(csn, SPI::ACTIVE_LOW, SPI::DIV128_CLOCK, 0, SPI::MSB_ORDER, NULL),
-    m_type(TYPE_UNKNOWN)
+    m_type(TYPE_UNKNOWN),
+    m_stream(NO_STREAM)
   {}
 #elif defined(WICKEDDEVICE_WILDFIRE)
   SD(Board::DigitalPin csn = Board::D16) :
     SPI::Driver(csn, SPI::ACTIVE_LOW, SPI::DIV128_CLOCK, 0, SPI::MSB_ORDER, NULL),
-    m_type(TYPE_UNKNOWN)
+    m_type(TYPE_UNKNOWN),
+    m_stream(NO_STREAM)
   {}
 #else
   SD(Board::DigitalPin csn = Board::D8) :
     SPI::Driver(csn, SPI::ACTIVE_LOW, SPI::DIV128_CLOCK, 0, SPI::MSB_ORDER, NULL),
-    m_type(TYPE_UNKNOWN)
+    m_type(TYPE_UNKNOWN),
+    m_stream(NO_STREAM)
   {}
 #endif
 
@@ -483,6 +527,67 @@ public:
    * @return bool.
    */
   bool write(uint32_t block, const uint8_t* src);
+
+  /**
+   * Start a multiple block read session from the given block
+   * address (READ_MULTIPLE_BLOCK). The blocks are received in
+   * sequence with read_next() and the session is terminated with
+   * end_read(). The SPI bus is held during the session and other
+   * card operations are not allowed. Returns true if successful
+   * otherwise false.
+   * @param[in] block start address.
+   * @return bool.
+   */
+  bool begin_read(uint32_t block);
+
+  /**
+   * Read next block in the multiple block read session into the
+   * given destination buffer. The buffer must be able to hold
+   * BLOCK_MAX bytes. Returns true if successful otherwise false.
+   * @param[in] dst pointer to destination buffer.
+   * @return bool.
+   */
+  bool read_next(uint8_t* dst);
+
+  /**
+   * Terminate the multiple block read session (STOP_TRANSMISSION)
+   * and release the SPI bus. Returns true if successful otherwise
+   * false.
+   * @return bool.
+   */
+  bool end_read();
+
+  /**
+   * Start a multiple block write session at the given block address
+   * (WRITE_MULTIPLE_BLOCK). The number of blocks that will be written
+   * may be given as a hint to the card to pre-erase the blocks
+   * (SET_WR_BLK_ERASE_COUNT) and improve the write throughput. The
+   * blocks are transmitted in sequence with write_next() and the
+   * session is terminated with end_write(). The SPI bus is held
+   * during the session and other card operations are not
+   * allowed. Returns true if successful otherwise false.
+   * @param[in] block start address.
+   * @param[in] count number of blocks to pre-erase (default 0, none).
+   * @return bool.
+   */
+  bool begin_write(uint32_t block, uint32_t count = 0L);
+
+  /**
+   * Write given source buffer with BLOCK_MAX bytes as the next
+   * block in the multiple block write session. Returns true if
+   * successful otherwise false.
+   * @param[in] src pointer to source buffer.
+   * @return bool.
+   */
+  bool write_next(const uint8_t* src);
+
+  /**
+   * Terminate the multiple block write session (stop transmission
+   * token), wait for the card to complete programming and release
+   * the SPI bus. Returns true if successful otherwise false.
+   * @return bool.
+   */
+  bool end_write();
 };
 
 #endif
@@ -0,0 +1,110 @@
+/**
+ * @file CosaSDbenchmark.ino
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2015, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * @section Description
+ * Benchmark SD single block and multiple block (streaming) read and
+ * write. Note: The blocks in the benchmark area are overwritten.
+ *
+ * @section Circuit
+ * SD card module on SPI pins (MOSI, MISO, SCK) and chip select
+ * D10 (data logging shield).
+ *
+ * This file is part of the Arduino Che Cosa project.
+ */
+
+#include <SD.h>
+
+#include "Cosa/RTT.hh"
+#include "Cosa/Trace.hh"
+#include "Cosa/UART.hh"
+#include "Cosa/Memory.h"
+
+// Benchmark block area; start block address and number of blocks
+#define BLOCK_START 100000L
+#define BLOCK_COUNT 64
+
+SD sd(Board::D10);
+
+/**
+ * Print transfer rate for given number of blocks and milli-seconds.
+ * @param[in] name of benchmark.
+ * @param[in] ms milli-seconds.
+ */
+void result(str_P name, uint32_t ms)
+{
+  trace << name << ms << PSTR(" ms, ")
+	<< (BLOCK_COUNT * SD::BLOCK_MAX * 1000L) / ms
+	<< PSTR(" byte/s") << endl;
+}
+
+void setup()
+{
+  uart.begin(9600);
+  trace.begin(&uart, PSTR("CosaSDbenchmark: started"));
+  TRACE(free_memory());
+  TRACE(sizeof(SD));
+  RTT::begin();
+  ASSERT(sd.begin(SPI::DIV2_CLOCK));
+  TRACE(sd.type());
+  TRACE(BLOCK_COUNT);
+}
+
+void loop()
+{
+  uint8_t buf[SD::BLOCK_MAX];
+  uint32_t start;
+  uint32_t ms;
+
+  for (uint16_t i = 0; i < sizeof(buf); i++) buf[i] = i;
+
+  // Single block write and read
+  start = RTT::millis();
+  for (uint16_t i = 0; i < BLOCK_COUNT; i++)
+    ASSERT(sd.write(BLOCK_START + i, buf));
+  ms = RTT::millis() - start;
+  result(PSTR("write:"), ms);
+
+  start = RTT::millis();
+  for (uint16_t i = 0; i < BLOCK_COUNT; i++)
+    ASSERT(sd.read(BLOCK_START + i, buf));
+  ms = RTT::millis() - start;
+  result(PSTR("read:"), ms);
+
+  // Multiple block write with pre-erase hint and read
+  start = RTT::millis();
+  ASSERT(sd.begin_write(BLOCK_START, BLOCK_COUNT));
+  for (uint16_t i = 0; i < BLOCK_COUNT; i++)
+    ASSERT(sd.write_next(buf));
+  ASSERT(sd.end_write());
+  ms = RTT::millis() - start;
+  result(PSTR("stream write:"), ms);
+
+  start = RTT::millis();
+  ASSERT(sd.begin_read(BLOCK_START));
+  for (uint16_t i = 0; i < BLOCK_COUNT; i++)
+    ASSERT(sd.read_next(buf));
+  ASSERT(sd.end_read());
+  ms = RTT::millis() - start;
+  result(PSTR("stream read:"), ms);
+
+  // Verify the content of the last block
+  for (uint16_t i = 0; i < sizeof(buf); i++)
+    ASSERT(buf[i] == (uint8_t) i);
+
+  ASSERT(sd.end());
+  ASSERT(true == false);
+}
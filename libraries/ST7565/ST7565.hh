@@ -35,7 +35,8 @@
  * text scroll, cursor, and handling of special characters such as
  * carriage-return, form-feed, back-space, horizontal tab and
  * new-line. Graphics should be performed with OffScreen Canvas and
- * copied to the display with draw_bitmap().
+ * copied to the display with OffScreen::flush() (modified pages only)
+ * or draw_bitmap().
  *
  * @section Circuit
  * @code